@@ -9,6 +9,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 12:35 Team     added checker descriptors for rate scheduling and
+                         the cost accounting types & functions
  08/05/13 15:19 jec      modifications to suit new portable type definitions
  01/15/12 12:00 jec      new header for local types
  10/16/11 17:17 jec      started coding
@@ -23,6 +25,27 @@ typedef bool CheckFunc (void);
 
 typedef CheckFunc (*pCheckFunc);
 
+// one entry in EVENT_CHECK_TABLE, use ES_CHECKER() to build these
+typedef struct
+{
+  pCheckFunc  CheckFunc;  // the event checking function
+  const char  *Name;      // for reporting
+  uint16_t    Period;     // minimum ms between calls, 0 = every pass
+  uint8_t     Priority;   // higher numbers are checked first
+}ES_CheckerDesc_t;
+
+#define ES_CHECKER(Func, Period, Priority) { Func, #Func, Period, Priority }
+
+typedef struct
+{
+  uint32_t NumCalls;      // times the checker has been run
+  uint32_t TotalCycles;   // core timer counts spent in the checker
+  uint32_t MaxCycles;     // longest single call, core timer counts
+}ES_CheckerStats_t;
+
+void ES_InitUserEvents(void);
 bool ES_CheckUserEvents(void);
+uint8_t ES_GetNumCheckers(void);
+const char *ES_GetCheckerStats(uint8_t WhichChecker, ES_CheckerStats_t *pStats);
 
 #endif  // ES_CheckEvents_H
@@ -9,6 +9,20 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 15:30 Team     ES_COMMAND_RETRIEVED is no longer coalesced, and
+                         POOL_EVENT_LIST excludes COALESCE_LIST
+ 10/17/26 15:05 Team     added BH_SHORT_TIMER
+ 10/17/26 13:00 Team     added bottom half numbers
+ 10/17/26 12:35 Team     EVENT_CHECK_LIST became EVENT_CHECK_TABLE with a
+                         period & priority for each checker
+ 10/17/26 11:45 Team     added ES_USE_EDF
+ 10/17/26 11:20 Team     added event payload pool settings
+ 10/17/26 10:55 Team     added COALESCE_LIST
+ 10/17/26 10:30 Team     added ES_BATCH_SIZE
+ 10/17/26 10:05 Team     added ES_NUM_EVENT_TYPES to size the subscription
+                         table. DIST_LISTn entries are now service numbers
+ 10/17/26 09:10 Team     raised MAX_NUM_SERVICES to 32 and added response
+                         function entries for timers 16-31
  12/19/16 20:19  jec     removed EVENT_CHECK_HEADER definition. This goes with
                          the V2.3 move to a single wrapper for event checking
                          headers
@@ -26,15 +40,32 @@
 
 /****************************************************************************/
 // The maximum number of services sets an upper bound on the number of
-// services that the framework will handle. Reasonable values are 8 and 16
-// corresponding to an 8-bit(uint8_t) and 16-bit(uint16_t) Ready variable size
-#define MAX_NUM_SERVICES 16
+// services that the framework will handle. The Ready variable is 32 bits
+// (uint32_t), so values up to 32 are supported. Services beyond 15 need
+// their SERV_n_ block added below following the pattern of the others.
+#define MAX_NUM_SERVICES 32
 
 /****************************************************************************/
 // This macro determines that nuber of services that are *actually* used in
 // a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
 #define NUM_SERVICES 3
 
+/****************************************************************************/
+// Batch dispatch: once ES_Run selects a service it may hand that service up
+// to this many of its queued events in a row, as long as no higher priority
+// service becomes ready in between. 1 disables batching.
+#define ES_BATCH_SIZE 1
+
+/****************************************************************************/
+// Earliest-deadline-first dispatch. When 1, ES_Run hands out the event whose
+// deadline comes soonest instead of always serving the highest numbered
+// ready service. Services declare relative deadlines for the events they
+// care about with ES_SetDeadline(); other events get ES_EDF_DEFAULT_DEADLINE
+// (ms). ES_GetDeadlineMisses() reports where the schedule is infeasible.
+// Batch dispatch can not be combined with this, set ES_BATCH_SIZE to 1.
+#define ES_USE_EDF 0
+#define ES_EDF_DEFAULT_DEADLINE 100
+
 /****************************************************************************/
 // These are the definitions for Service 0, the lowest priority service.
 // Every Events and Services application must have a Service 0. Further
@@ -276,42 +307,81 @@ typedef enum
   EV_SCOOP_RETRACT,         /* Retract scoop servo */
   EV_SIDE_BLUE,             /* Set side servo to blue field position */
   EV_SIDE_GREEN,            /* Set side servo to green field position */
-  EV_SIDE_MIDDLE            /* Set side servo to middle (neutral) position */
+  EV_SIDE_MIDDLE,           /* Set side servo to middle (neutral) position */
+  ES_NUM_EVENT_TYPES         /* must stay last, sizes the subscription table */
 }ES_EventType_t;
 
+/****************************************************************************/
+// Event coalescing. Event types listed here do not take a new queue slot
+// when an event that matches is still waiting in the service's queue.
+// ES_COALESCE_LATEST overwrites a pending event of the same type (use for
+// producers where only the latest value matters), ES_COALESCE_DUPLICATES
+// only drops an exact copy (same type and param) of the newest pending
+// event. Do not coalesce events that trigger an action each time.
+// Entries are designated initializers: [EventType] = mode, comma separated.
+// Comment out the define if no event types are coalesced.
+// SPI command bytes are action triggers, a repeat must run again
+//#define COALESCE_LIST [ES_COMMAND_RETRIEVED] = ES_COALESCE_DUPLICATES
+
+/****************************************************************************/
+// Event payload pool. Events that need more than the 16-bit EventParam can
+// carry a handle to a fixed-size block from ES_EventPool instead. Set the
+// number of blocks (0 to 32, 0 disables the pool) and the block size in
+// bytes. List the event types that carry a handle in POOL_EVENT_LIST as
+// [EventType] = true; the framework releases their block after the run
+// function. Pool events cannot be coalesced, so POOL_EVENT_LIST and
+// COALESCE_LIST cannot both be defined (ES_EventPool.c stops the build).
+#define ES_POOL_NUM_BLOCKS 0
+#define ES_POOL_BLOCK_SIZE 16
+//#define POOL_EVENT_LIST [ES_SOME_EVENT] = true
+
 /****************************************************************************/
 // These are the definitions for the Distribution lists. Each definition
-// should be a comma separated list of post functions to indicate which
-// services are on that distribution list.
+// should be a comma separated list of service numbers to indicate which
+// services start out on that distribution list. Membership can be changed
+// at run time with ES_AddToDistList/ES_RemoveFromDistList.
 #define NUM_DIST_LISTS 0
 #if NUM_DIST_LISTS > 0
-#define DIST_LIST0 PostTestHarnessService0, PostTestHarnessService0
+#define DIST_LIST0 0
 #endif
 #if NUM_DIST_LISTS > 1
-#define DIST_LIST1 PostTestHarnessService1, PostTestHarnessService1
+#define DIST_LIST1 0
 #endif
 #if NUM_DIST_LISTS > 2
-#define DIST_LIST2 PostTemplateFSM
+#define DIST_LIST2 0
 #endif
 #if NUM_DIST_LISTS > 3
-#define DIST_LIST3 PostTemplateFSM
+#define DIST_LIST3 0
 #endif
 #if NUM_DIST_LISTS > 4
-#define DIST_LIST4 PostTemplateFSM
+#define DIST_LIST4 0
 #endif
 #if NUM_DIST_LISTS > 5
-#define DIST_LIST5 PostTemplateFSM
+#define DIST_LIST5 0
 #endif
 #if NUM_DIST_LISTS > 6
-#define DIST_LIST6 PostTemplateFSM
+#define DIST_LIST6 0
 #endif
 #if NUM_DIST_LISTS > 7
-#define DIST_LIST7 PostTemplateFSM
+#define DIST_LIST7 0
 #endif
 
 /****************************************************************************/
-// This is the list of event checking functions
-#define EVENT_CHECK_LIST Check4Keystroke
+// Bottom half numbers (0-31) for deferred ISR work. An ISR raises its bottom
+// half with _HW_RaiseBottomHalf and the handler its service registered with
+// _HW_RegisterBottomHalf runs at task level before the next dispatch.
+// Higher numbers run first.
+#define BH_SHORT_TIMER    1   // short timer channel expired, ES_ShortTimer
+#define BH_SPI_COMMAND    0   // SPI byte(s) received, SPIFollowerFSM
+
+/****************************************************************************/
+// This is the table of event checking functions. Each entry is
+// ES_CHECKER(function, minimum period in ms, priority). A period of 0 runs
+// the checker on every pass through ES_Run; higher priorities are checked
+// first. Keystrokes are checked every pass since the UART RX FIFO is only
+// a few characters deep.
+#define EVENT_CHECK_TABLE \
+  ES_CHECKER(Check4Keystroke, 0, 1)
 
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
@@ -340,6 +410,22 @@ typedef enum
 #define TIMER13_RESP_FUNC TIMER_UNUSED
 #define TIMER14_RESP_FUNC TIMER_UNUSED
 #define TIMER15_RESP_FUNC PostTestHarnessService0
+#define TIMER16_RESP_FUNC TIMER_UNUSED
+#define TIMER17_RESP_FUNC TIMER_UNUSED
+#define TIMER18_RESP_FUNC TIMER_UNUSED
+#define TIMER19_RESP_FUNC TIMER_UNUSED
+#define TIMER20_RESP_FUNC TIMER_UNUSED
+#define TIMER21_RESP_FUNC TIMER_UNUSED
+#define TIMER22_RESP_FUNC TIMER_UNUSED
+#define TIMER23_RESP_FUNC TIMER_UNUSED
+#define TIMER24_RESP_FUNC TIMER_UNUSED
+#define TIMER25_RESP_FUNC TIMER_UNUSED
+#define TIMER26_RESP_FUNC TIMER_UNUSED
+#define TIMER27_RESP_FUNC TIMER_UNUSED
+#define TIMER28_RESP_FUNC TIMER_UNUSED
+#define TIMER29_RESP_FUNC TIMER_UNUSED
+#define TIMER30_RESP_FUNC TIMER_UNUSED
+#define TIMER31_RESP_FUNC TIMER_UNUSED
 
 /****************************************************************************/
 // Give the timer numbers symbolc names to make it easier to move them
@@ -0,0 +1,36 @@
+/****************************************************************************
+ Module
+     ES_EventPool.h
+ Description
+     header file for the fixed-block event payload pool of the Events &
+     Services framework
+ Notes
+     An event that needs more than the 16-bit EventParam carries a pool
+     handle in EventParam instead. The producer allocates a block, fills it
+     in and posts the handle. The framework releases the block after the
+     consumer's run function returns, for event types listed in
+     POOL_EVENT_LIST in ES_Configure.h.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26 11:20 Team     started coding
+*****************************************************************************/
+#ifndef ES_EventPool_H
+#define ES_EventPool_H
+
+#include "ES_Types.h"
+#include "ES_Events.h"
+
+// handle value that never refers to a block, returned when the pool is empty
+#define ES_POOL_NO_HANDLE 0
+
+void ES_EventPool_Init(void);
+uint16_t ES_EventPool_Alloc(void);
+void *ES_EventPool_GetPtr(uint16_t Handle);
+void ES_EventPool_AddRef(uint16_t Handle, uint8_t NumRefs);
+void ES_EventPool_Release(uint16_t Handle);
+uint8_t ES_EventPool_NumFree(void);
+bool ES_EventPool_IsPoolEvent(ES_EventType_t EventType);
+
+#endif /* ES_EventPool_H */
@@ -8,6 +8,9 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 15:30 Team     EDF-off deadline stubs are static inline functions
+ 10/17/26 11:45 Team     added EDF deadline declarations
+ 10/17/26 10:05 Team     added publish/subscribe prototypes
  11/02/13 17:06 jec      added ES_PostToServiceLIFO prototype
  08/05/13 15:00 jec      added #include for ES_Port.h to get portability stuff
  10/17/06 07:41 jec      started coding
@@ -45,5 +48,31 @@ ES_Return_t ES_Run(void);
 bool ES_PostAll(ES_Event_t ThisEvent);
 bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent);
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent);
+bool ES_PostToServices(uint32_t ServiceMask, ES_Event_t TheEvent);
+bool ES_Subscribe(uint8_t WhichService, ES_EventType_t EventType);
+bool ES_Unsubscribe(uint8_t WhichService, ES_EventType_t EventType);
+bool ES_Publish(ES_Event_t ThisEvent);
+
+// services may always declare deadlines, they only take effect with EDF on
+#if ES_USE_EDF
+bool ES_SetDeadline(uint8_t WhichService, ES_EventType_t EventType,
+    uint16_t Deadline);
+uint16_t ES_GetDeadlineMisses(uint8_t WhichService);
+#else
+// stubs rather than macros, so a call whose result is ignored is warning free
+static inline bool ES_SetDeadline(uint8_t WhichService,
+    ES_EventType_t EventType, uint16_t Deadline)
+{
+  (void)WhichService;
+  (void)EventType;
+  (void)Deadline;
+  return true;
+}
+static inline uint16_t ES_GetDeadlineMisses(uint8_t WhichService)
+{
+  (void)WhichService;
+  return 0;
+}
+#endif
 
 #endif   // ES_Framework_H
@@ -32,7 +32,7 @@ void Terminal_HWInit(void);
 uint8_t Terminal_ReadByte(void);
 void Terminal_WriteByte(uint8_t txByte);
 bool Terminal_IsRxData(void);
-void Terminal_MoveBuffer2UART( void );
+bool Terminal_MoveBuffer2UART( void );
 
 #ifdef __XC16__  // DEPRICATED, USE FOR xc16 of xc32 v1.34 or lower
 int write(int handle, void *buffer, unsigned int len);
@@ -0,0 +1,285 @@
+/****************************************************************************
+ Module
+     ES_EventPool.c
+
+ Description
+     Fixed-block pool for event payloads that do not fit in EventParam.
+     Producers (task level or ISRs) allocate a block, fill it and post the
+     handle in EventParam. The framework releases the block once every
+     service it was posted to has run with it.
+
+ Notes
+     Free blocks are tracked as bits in one 32-bit word, so allocation is a
+     CLZ to find a free block plus an LL/SC compare and swap to claim it.
+     No interrupts are disabled, so allocate/release are O(1) and safe at
+     any IPL. Each block carries a reference count so that one payload can
+     be posted to several services (ES_PostToServices/ES_Publish).
+
+     Handles are block number + 1, so that 0 (ES_POOL_NO_HANDLE) is never
+     a valid handle.
+
+     Event types that carry a handle must not be coalesced, since an
+     overwritten pending event would never release its block. The lists
+     cannot be checked entry by entry at compile time, so POOL_EVENT_LIST
+     and COALESCE_LIST may not both be defined.
+     A service that wants to keep a payload past the end of its run
+     function (for example by deferring the event) must call
+     ES_EventPool_AddRef before it returns and release it itself later.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26 15:30 Team     #error if POOL_EVENT_LIST and COALESCE_LIST are both
+                         defined
+ 10/17/26 11:20 Team     started coding
+****************************************************************************/
+
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_LookupTables.h"
+#include "ES_EventPool.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#ifndef ES_POOL_NUM_BLOCKS
+#define ES_POOL_NUM_BLOCKS 0
+#endif
+
+#if ES_POOL_NUM_BLOCKS > 32
+#error "ES_POOL_NUM_BLOCKS can be at most 32 (one bit per block)"
+#endif
+
+#if defined(POOL_EVENT_LIST) && defined(COALESCE_LIST)
+#error "POOL_EVENT_LIST and COALESCE_LIST cannot both be defined: a coalesced pool event leaks its block"
+#endif
+
+#if ES_POOL_NUM_BLOCKS > 0
+// blocks are stored as words so that any payload struct is aligned
+#define POOL_BLOCK_WORDS ((ES_POOL_BLOCK_SIZE + 3) / 4)
+#define ALL_BLOCKS_FREE (0xFFFFFFFFUL >> (32 - ES_POOL_NUM_BLOCKS))
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint32_t PoolBlocks[ES_POOL_NUM_BLOCKS][POOL_BLOCK_WORDS];
+static volatile uint32_t RefCounts[ES_POOL_NUM_BLOCKS];
+// bit n set means block n is free
+static volatile uint32_t FreeBlocks;
+#endif
+
+// which event types carry a pool handle, from POOL_EVENT_LIST
+static const bool PoolEventTypes[ES_NUM_EVENT_TYPES] = {
+#ifdef POOL_EVENT_LIST
+  POOL_EVENT_LIST
+#else
+  false
+#endif
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_EventPool_Init
+ Parameters
+     None
+ Returns
+     None
+ Description
+     marks every block in the pool as free
+ Notes
+     called from ES_Initialize
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void ES_EventPool_Init(void)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  uint8_t i;
+  for (i = 0; i < ES_POOL_NUM_BLOCKS; i++)
+  {
+    RefCounts[i] = 0;
+  }
+  FreeBlocks = ALL_BLOCKS_FREE;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_Alloc
+ Parameters
+     None
+ Returns
+     uint16_t handle of the claimed block, ES_POOL_NO_HANDLE if none free
+ Description
+     claims a free block with a reference count of 1
+ Notes
+     lock free, may be called from ISRs. If the retry loop loses a race
+     with an ISR it simply tries again with the new free mask.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint16_t ES_EventPool_Alloc(void)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  uint32_t  Free;
+  uint8_t   Block;
+
+  do
+  {
+    Free = FreeBlocks;
+    if (Free == 0)
+    {
+      return ES_POOL_NO_HANDLE;
+    }
+    Block = ES_GetMSBitSet(Free);
+  } while (!ES_AtomicCompareAndSwap(&FreeBlocks, Free,
+      Free & BitNum2ClrMask[Block]));
+
+  RefCounts[Block] = 1;
+  return (uint16_t)(Block + 1);
+#else
+  return ES_POOL_NO_HANDLE;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_GetPtr
+ Parameters
+     uint16_t Handle : handle from ES_EventPool_Alloc (or EventParam)
+ Returns
+     void * pointer to the block, NULL for an invalid handle
+ Description
+     converts a handle into a pointer to the payload block
+ Notes
+     the block is ES_POOL_BLOCK_SIZE bytes and word aligned
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void *ES_EventPool_GetPtr(uint16_t Handle)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  if ((Handle == ES_POOL_NO_HANDLE) || (Handle > ES_POOL_NUM_BLOCKS))
+  {
+    return (void *)0;
+  }
+  return (void *)PoolBlocks[Handle - 1];
+#else
+  return (void *)0;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_AddRef
+ Parameters
+     uint16_t Handle : the block to add references to
+     uint8_t NumRefs : how many references to add
+ Returns
+     None
+ Description
+     adds references to a block, one for each extra holder
+ Notes
+     used by the framework when one payload is posted to several services
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void ES_EventPool_AddRef(uint16_t Handle, uint8_t NumRefs)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  if ((Handle != ES_POOL_NO_HANDLE) && (Handle <= ES_POOL_NUM_BLOCKS))
+  {
+    (void)ES_AtomicAddFetch(&RefCounts[Handle - 1], NumRefs);
+  }
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_Release
+ Parameters
+     uint16_t Handle : the block to release
+ Returns
+     None
+ Description
+     drops one reference, the block goes back to the pool on the last one
+ Notes
+     lock free, may be called from ISRs. Releasing an invalid handle or a
+     block that is already free is ignored.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void ES_EventPool_Release(uint16_t Handle)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  uint8_t Block;
+
+  if ((Handle == ES_POOL_NO_HANDLE) || (Handle > ES_POOL_NUM_BLOCKS))
+  {
+    return;
+  }
+  Block = (uint8_t)(Handle - 1);
+  if ((FreeBlocks & BitNum2SetMask[Block]) != 0)
+  {
+    return; // already free, don't let the count wrap
+  }
+  if (ES_AtomicAddFetch(&RefCounts[Block], -1) == 0)
+  {
+    ES_AtomicSetBits(&FreeBlocks, BitNum2SetMask[Block]);
+  }
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_NumFree
+ Parameters
+     None
+ Returns
+     uint8_t number of free blocks
+ Description
+     for monitoring pool use
+ Notes
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint8_t ES_EventPool_NumFree(void)
+{
+#if ES_POOL_NUM_BLOCKS > 0
+  uint32_t  Free = FreeBlocks;
+  uint8_t   NumFree = 0;
+  while (Free != 0)
+  {
+    Free &= (Free - 1); // clear the lowest set bit
+    NumFree++;
+  }
+  return NumFree;
+#else
+  return 0;
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_EventPool_IsPoolEvent
+ Parameters
+     ES_EventType_t EventType : type to check
+ Returns
+     bool true if events of this type carry a pool handle in EventParam
+ Description
+     looks the type up in the table built from POOL_EVENT_LIST
+ Notes
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool ES_EventPool_IsPoolEvent(ES_EventType_t EventType)
+{
+  if (EventType >= ES_NUM_EVENT_TYPES)
+  {
+    return false;
+  }
+  return PoolEventTypes[EventType];
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -8,6 +8,25 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 12:35 Team    ES_Initialize sets up the event checker schedule
+ 10/17/26 12:10 Team    ES_Run waits in Idle mode when a pass finds no work
+ 10/17/26 11:45 Team    added optional earliest-deadline-first dispatch
+                        (ES_USE_EDF) with per service/event type deadlines
+                        and deadline miss counters
+ 10/17/26 11:20 Team    hooked in the event payload pool, blocks carried by
+                        POOL_EVENT_LIST events are released after the run
+                        function and get one reference per target service
+ 10/17/26 10:55 Team    added event coalescing, event types listed in
+                        COALESCE_LIST are merged with a matching pending event
+ 10/17/26 10:30 Team    added optional batch dispatch (ES_BATCH_SIZE) to ES_Run
+ 10/17/26 10:05 Team    added per-event-type subscriptions (ES_Subscribe,
+                        ES_Publish) and the all-or-nothing ES_PostToServices,
+                        ES_PostAll now uses it so it can't half-deliver
+ 10/17/26 09:40 Team    Ready is now only modified with atomic set/clear so
+                        that posts from ISRs can not be lost. ES_Run clears
+                        the ready bit before pulling the event, not after
+ 10/17/26 09:10 Team    widened Ready to 32 bits and added entries to expand
+                        the number of possible services to 32
  08/21/17 13:18 jec     added conditional call to initialize the port lines
                         for the hardware debugging of the framework/apps
  12/19/16 20:18 jec      changed includes to accomodate the change to a fixed
@@ -34,6 +53,7 @@
 #include "../FrameworkHeaders/ES_Timers.h"
 #include "../FrameworkHeaders/ES_General.h"
 #include "../FrameworkHeaders/ES_CheckEvents.h"
+#include "../FrameworkHeaders/ES_EventPool.h"
 // Include the header files for the Service modules.
 // This gets you the prototypes for the public service functions.
 
@@ -50,6 +70,30 @@
 #endif
 
 /*----------------------------- Module Defines ----------------------------*/
+// Max number of events a selected service may process back to back before
+// the scheduler looks at Ready again. 1 gives the classic one event per
+// selection behavior. Override in ES_Configure.h
+#ifndef ES_BATCH_SIZE
+#define ES_BATCH_SIZE 1
+#endif
+
+// Earliest-deadline-first dispatch, off unless enabled in ES_Configure.h
+#ifndef ES_USE_EDF
+#define ES_USE_EDF 0
+#endif
+#if ES_USE_EDF
+// deadline (ms) for events that their service has not given one
+#ifndef ES_EDF_DEFAULT_DEADLINE
+#define ES_EDF_DEFAULT_DEADLINE 100
+#endif
+#if ES_BATCH_SIZE > 1
+#error "ES_BATCH_SIZE must be 1 when ES_USE_EDF is enabled"
+#endif
+#endif
+
+// one bit for each service that is actually in use
+#define ALL_SERVICES_MASK (0xFFFFFFFFUL >> (32 - NUM_SERVICES))
+
 typedef bool      InitFunc_t (uint8_t Priority);
 typedef ES_Event_t  RunFunc_t (ES_Event_t ThisEvent);
 
@@ -72,6 +116,12 @@ typedef struct
 
 /*---------------------------- Module Functions ---------------------------*/
 //static bool CheckSystemEvents( void );
+static ES_CoalesceMode_t GetCoalesceMode(ES_EventType_t EventType);
+#if ES_USE_EDF
+static uint16_t GetDeadline(uint8_t WhichService, ES_EventType_t EventType);
+static uint8_t SelectEarliestDeadline(uint32_t ReadySet);
+static void CheckDeadline(uint8_t WhichService, ES_Event_t ThisEvent);
+#endif
 
 /*---------------------------- Module Variables ---------------------------*/
 /****************************************************************************/
@@ -128,6 +178,54 @@ static ES_ServDesc_t const ServDescList[] =
 #if NUM_SERVICES > 15
   , { SERV_15_INIT, SERV_15_RUN }
 #endif
+#if NUM_SERVICES > 16
+  , { SERV_16_INIT, SERV_16_RUN }
+#endif
+#if NUM_SERVICES > 17
+  , { SERV_17_INIT, SERV_17_RUN }
+#endif
+#if NUM_SERVICES > 18
+  , { SERV_18_INIT, SERV_18_RUN }
+#endif
+#if NUM_SERVICES > 19
+  , { SERV_19_INIT, SERV_19_RUN }
+#endif
+#if NUM_SERVICES > 20
+  , { SERV_20_INIT, SERV_20_RUN }
+#endif
+#if NUM_SERVICES > 21
+  , { SERV_21_INIT, SERV_21_RUN }
+#endif
+#if NUM_SERVICES > 22
+  , { SERV_22_INIT, SERV_22_RUN }
+#endif
+#if NUM_SERVICES > 23
+  , { SERV_23_INIT, SERV_23_RUN }
+#endif
+#if NUM_SERVICES > 24
+  , { SERV_24_INIT, SERV_24_RUN }
+#endif
+#if NUM_SERVICES > 25
+  , { SERV_25_INIT, SERV_25_RUN }
+#endif
+#if NUM_SERVICES > 26
+  , { SERV_26_INIT, SERV_26_RUN }
+#endif
+#if NUM_SERVICES > 27
+  , { SERV_27_INIT, SERV_27_RUN }
+#endif
+#if NUM_SERVICES > 28
+  , { SERV_28_INIT, SERV_28_RUN }
+#endif
+#if NUM_SERVICES > 29
+  , { SERV_29_INIT, SERV_29_RUN }
+#endif
+#if NUM_SERVICES > 30
+  , { SERV_30_INIT, SERV_30_RUN }
+#endif
+#if NUM_SERVICES > 31
+  , { SERV_31_INIT, SERV_31_RUN }
+#endif
 };
 
 /****************************************************************************/
@@ -179,6 +277,54 @@ static ES_Event_t Queue14[SERV_14_QUEUE_SIZE + 1];
 #if NUM_SERVICES > 15
 static ES_Event_t Queue15[SERV_15_QUEUE_SIZE + 1];
 #endif
+#if NUM_SERVICES > 16
+static ES_Event_t Queue16[SERV_16_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 17
+static ES_Event_t Queue17[SERV_17_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 18
+static ES_Event_t Queue18[SERV_18_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 19
+static ES_Event_t Queue19[SERV_19_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 20
+static ES_Event_t Queue20[SERV_20_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 21
+static ES_Event_t Queue21[SERV_21_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 22
+static ES_Event_t Queue22[SERV_22_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 23
+static ES_Event_t Queue23[SERV_23_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 24
+static ES_Event_t Queue24[SERV_24_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 25
+static ES_Event_t Queue25[SERV_25_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 26
+static ES_Event_t Queue26[SERV_26_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 27
+static ES_Event_t Queue27[SERV_27_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 28
+static ES_Event_t Queue28[SERV_28_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 29
+static ES_Event_t Queue29[SERV_29_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 30
+static ES_Event_t Queue30[SERV_30_QUEUE_SIZE + 1];
+#endif
+#if NUM_SERVICES > 31
+static ES_Event_t Queue31[SERV_31_QUEUE_SIZE + 1];
+#endif
 
 /****************************************************************************/
 // array of queue descriptors for posting by priority level
@@ -230,12 +376,84 @@ static ES_QueueDesc_t const EventQueues[NUM_SERVICES] = {
 #if NUM_SERVICES > 15
   , { Queue15, ARRAY_SIZE(Queue15) }
 #endif
+#if NUM_SERVICES > 16
+  , { Queue16, ARRAY_SIZE(Queue16) }
+#endif
+#if NUM_SERVICES > 17
+  , { Queue17, ARRAY_SIZE(Queue17) }
+#endif
+#if NUM_SERVICES > 18
+  , { Queue18, ARRAY_SIZE(Queue18) }
+#endif
+#if NUM_SERVICES > 19
+  , { Queue19, ARRAY_SIZE(Queue19) }
+#endif
+#if NUM_SERVICES > 20
+  , { Queue20, ARRAY_SIZE(Queue20) }
+#endif
+#if NUM_SERVICES > 21
+  , { Queue21, ARRAY_SIZE(Queue21) }
+#endif
+#if NUM_SERVICES > 22
+  , { Queue22, ARRAY_SIZE(Queue22) }
+#endif
+#if NUM_SERVICES > 23
+  , { Queue23, ARRAY_SIZE(Queue23) }
+#endif
+#if NUM_SERVICES > 24
+  , { Queue24, ARRAY_SIZE(Queue24) }
+#endif
+#if NUM_SERVICES > 25
+  , { Queue25, ARRAY_SIZE(Queue25) }
+#endif
+#if NUM_SERVICES > 26
+  , { Queue26, ARRAY_SIZE(Queue26) }
+#endif
+#if NUM_SERVICES > 27
+  , { Queue27, ARRAY_SIZE(Queue27) }
+#endif
+#if NUM_SERVICES > 28
+  , { Queue28, ARRAY_SIZE(Queue28) }
+#endif
+#if NUM_SERVICES > 29
+  , { Queue29, ARRAY_SIZE(Queue29) }
+#endif
+#if NUM_SERVICES > 30
+  , { Queue30, ARRAY_SIZE(Queue30) }
+#endif
+#if NUM_SERVICES > 31
+  , { Queue31, ARRAY_SIZE(Queue31) }
+#endif
 };
 
 /****************************************************************************/
 // Variable used to keep track of which queues have events in them
+// one bit per service, so this sets the upper limit of MAX_NUM_SERVICES
+// Posts can come from ISRs at any priority, so this must only be changed
+// with ES_AtomicSetBits/ES_AtomicClrBits
 
-uint16_t Ready;
+volatile uint32_t Ready;
+
+// Subscription table, one bit per service for each event type. Published
+// events only go to the services that have a bit set for that type.
+static volatile uint32_t Subscribers[ES_NUM_EVENT_TYPES];
+
+// Coalescing mode for each event type, filled in from COALESCE_LIST in
+// ES_Configure.h. Types that are not listed are ES_COALESCE_NONE.
+static const uint8_t CoalesceModes[ES_NUM_EVENT_TYPES] = {
+#ifdef COALESCE_LIST
+  COALESCE_LIST
+#else
+  ES_COALESCE_NONE
+#endif
+};
+
+#if ES_USE_EDF
+// relative deadline in ms for each service & event type, 0 = not declared
+static uint16_t RelDeadlines[NUM_SERVICES][ES_NUM_EVENT_TYPES];
+// number of declared deadlines that were missed, per service
+static volatile uint16_t DeadlineMisses[NUM_SERVICES];
+#endif
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -257,6 +475,11 @@ ES_Return_t ES_Initialize(TimerRate_t NewRate)
 {
   uint8_t i;
   ES_Timer_Init(NewRate);  // start up the timer subsystem
+#if NUM_DIST_LISTS > 0
+  ES_InitDistLists();      // load the initial distribution list members
+#endif
+  ES_EventPool_Init();     // all payload blocks start out free
+  ES_InitUserEvents();     // put the event checkers in priority order
   // loop through the list testing for NULL pointers and
   for (i = 0; i < ARRAY_SIZE(ServDescList); i++)
   {
@@ -302,6 +525,9 @@ ES_Return_t ES_Run(void)
   // make these static to improve speed
   uint8_t         HighestPrior;
   static ES_Event_t ThisEvent;
+#if ES_BATCH_SIZE > 1
+  uint8_t         BatchLeft;
+#endif
 
   while (1)  // stay here unless we detect an error condition
   { // loop through the list executing the run functions for services
@@ -309,21 +535,58 @@ ES_Return_t ES_Run(void)
     // Ready
     while ((_HW_Process_Pending_Ints()) && (Ready != 0))
     {
+#if ES_USE_EDF
+      HighestPrior = SelectEarliestDeadline(Ready);
+#else
       HighestPrior = ES_GetMSBitSet(Ready);
-      if (ES_DeQueue(EventQueues[HighestPrior].pMem, &ThisEvent) == 0)
+#endif
+#if ES_BATCH_SIZE > 1
+      BatchLeft = ES_BATCH_SIZE;
+      do
       {
-        Ready &= BitNum2ClrMask[HighestPrior]; // mark queue as now empty
-      }
+#endif
+        // clear the ready bit *before* pulling the event. A post from an ISR
+        // that lands after this point sets the bit again, so it can never be
+        // wiped out by our clear. The cost is that such a post may leave the
+        // bit set for a queue we have already emptied, hence the empty test.
+        ES_AtomicClrBits(&Ready, BitNum2SetMask[HighestPrior]);
+        if (ES_IsQueueEmpty(EventQueues[HighestPrior].pMem))
+        {
+          // stale ready bit, nothing to run. Inside a batch this goes to the
+          // do/while test, which ends the batch since our bit is now clear,
+          // unless an ISR has posted to this service again in the meantime
+          continue;
+        }
+        if (ES_DeQueue(EventQueues[HighestPrior].pMem, &ThisEvent) != 0)
+        {
+          // still more events waiting, mark queue as non-empty again
+          ES_AtomicSetBits(&Ready, BitNum2SetMask[HighestPrior]);
+        }
+#if ES_USE_EDF
+        CheckDeadline(HighestPrior, ThisEvent);
+#endif
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugSetLine1();
+        _HW_DebugSetLine1();
 #endif
-      if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
-          ES_NO_EVENT)
-      {
-        return FailedRun;
-      }
+        if (ServDescList[HighestPrior].RunFunc(ThisEvent).EventType !=
+            ES_NO_EVENT)
+        {
+          return FailedRun;
+        }
+        // the service is done with any payload that came with the event
+        if (ES_EventPool_IsPoolEvent(ThisEvent.EventType))
+        {
+          ES_EventPool_Release(ThisEvent.EventParam);
+        }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
-      _HW_DebugClearLine1();
+        _HW_DebugClearLine1();
+#endif
+#if ES_BATCH_SIZE > 1
+        // keep going with the same service only while it still has events
+        // and nothing of higher priority has become ready. Pending ints are
+        // processed first so that timer posts can preempt the batch.
+      } while ((--BatchLeft != 0) && (_HW_Process_Pending_Ints()) &&
+          ((Ready >> HighestPrior) == 1));
 #endif
     }
 
@@ -333,7 +596,21 @@ ES_Return_t ES_Run(void)
     // all the queues are empty, so look for new user detected events
     if (!ES_CheckUserEvents()) // no new user events
     {
-      Terminal_MoveBuffer2UART(); // try moving bytes, if available, to UART
+      // try moving bytes, if available, to UART
+      if (!Terminal_MoveBuffer2UART()) // and nothing left to send
+      {
+#ifdef ES_IDLE_WAIT
+        // nothing to do until an interrupt happens, so wait for one. Ready
+        // is checked again with interrupts off to close the window in which
+        // an ISR could post just before we go idle.
+        EnterCritical();
+        if (Ready == 0)
+        {
+          _HW_Idle();
+        }
+        ExitCritical();
+#endif
+      }
     }
 #ifdef _INCLUDE_BASIC_FRAMEWORK_DEBUG_
     _HW_DebugClearLine2();
@@ -347,37 +624,18 @@ ES_Return_t ES_Run(void)
  Parameters
    ES_Event : The Event to be posted
  Returns
-   boolean : False if any of the post functions failed during execution
+   boolean : False if the event could not be posted to all of the services
  Description
    posts to all of the services' queues
  Notes
-
+   either every service gets the event or none does, see ES_PostToServices.
+   Prefer ES_Publish so that only interested services are woken.
  Author
    J. Edward Carryer, 01/15/12,
 ****************************************************************************/
 bool ES_PostAll(ES_Event_t ThisEvent)
 {
-  uint8_t i;
-  // loop through the list executing the post functions
-  for (i = 0; i < ARRAY_SIZE(EventQueues); i++)
-  {
-    if (ES_EnQueueFIFO(EventQueues[i].pMem, ThisEvent) != true)
-    {
-      break; // this is a failed post
-    }
-    else
-    {
-      Ready |= BitNum2SetMask[i]; // show queue as non-empty
-    }
-  }
-  if (i == ARRAY_SIZE(EventQueues))    // if no failures
-  {
-    return true;
-  }
-  else
-  {
-    return false;
-  }
+  return ES_PostToServices(ALL_SERVICES_MASK, ThisEvent);
 }
 
 /****************************************************************************
@@ -391,17 +649,23 @@ bool ES_PostAll(ES_Event_t ThisEvent)
  Description
    posts to one of the services' queues
  Notes
-   used by the timer library to associate a timer with a state machine
+   used by the timer library to associate a timer with a state machine.
+   Event types in COALESCE_LIST are merged with a matching pending event
+   rather than taking another queue slot
  Author
    J. Edward Carryer, 01/16/12,
 ****************************************************************************/
 bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 {
+#if ES_USE_EDF
+  TheEvent.PostTime = ES_Timer_GetTime();
+#endif
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
-      (ES_EnQueueFIFO(EventQueues[WhichService].pMem, TheEvent) ==
-        true))
+      (ES_EnQueueFIFOCoalesce(EventQueues[WhichService].pMem, TheEvent,
+        GetCoalesceMode(TheEvent.EventType)) == true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    // show queue as non-empty
+    ES_AtomicSetBits(&Ready, BitNum2SetMask[WhichService]);
     return true;
   }
   else
@@ -427,11 +691,15 @@ bool ES_PostToService(uint8_t WhichService, ES_Event_t TheEvent)
 ****************************************************************************/
 bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
 {
+#if ES_USE_EDF
+  TheEvent.PostTime = ES_Timer_GetTime();
+#endif
   if ((WhichService < ARRAY_SIZE(EventQueues)) &&
       (ES_EnQueueLIFO(EventQueues[WhichService].pMem, TheEvent) ==
         true))
   {
-    Ready |= BitNum2SetMask[WhichService]; // show queue as non-empty
+    // show queue as non-empty
+    ES_AtomicSetBits(&Ready, BitNum2SetMask[WhichService]);
     return true;
   }
   else
@@ -440,9 +708,336 @@ bool ES_PostToServiceLIFO(uint8_t WhichService, ES_Event_t TheEvent)
   }
 }
 
+/****************************************************************************
+ Function
+   ES_PostToServices
+ Parameters
+   uint32_t : bit mask of the services to post to (bit n = service n)
+   ES_Event : The Event to be posted
+ Returns
+   boolean : False if any of the queues was full, in which case the event
+             was not posted to any of them
+ Description
+   posts one event to a set of services in a single pass
+ Notes
+   the space check and all of the enqueues happen in one critical region
+   and the Ready bits are published with a single atomic OR, so this is
+   safe to call from ISRs. An empty mask is a successful post.
+   For POOL_EVENT_LIST events, if the post fails the poster still owns the
+   payload block and must release it.
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_PostToServices(uint32_t ServiceMask, ES_Event_t TheEvent)
+{
+  ES_Event_t  *Targets[NUM_SERVICES];
+  uint8_t     NumTargets = 0;
+  uint32_t    Remaining;
+  uint8_t     WhichService;
+  bool        IsPoolEvent;
+
+#if ES_USE_EDF
+  TheEvent.PostTime = ES_Timer_GetTime();
+#endif
+  ServiceMask &= ALL_SERVICES_MASK;
+  Remaining = ServiceMask;
+  while (Remaining != 0)
+  {
+    WhichService = ES_GetMSBitSet(Remaining);
+    Targets[NumTargets++] = EventQueues[WhichService].pMem;
+    Remaining &= BitNum2ClrMask[WhichService];
+  }
+  if (NumTargets == 0)
+  {
+    return true;
+  }
+  // a payload block needs one reference per receiving service. The poster
+  // holds the first, so add the rest before any of the services can run.
+  IsPoolEvent = ES_EventPool_IsPoolEvent(TheEvent.EventType);
+  if (IsPoolEvent && (NumTargets > 1))
+  {
+    ES_EventPool_AddRef(TheEvent.EventParam, NumTargets - 1);
+  }
+  if (ES_EnQueueFIFOMulti(Targets, NumTargets, TheEvent,
+      GetCoalesceMode(TheEvent.EventType)) != true)
+  {
+    if (IsPoolEvent)
+    {
+      // undo the extra references, the poster still owns its own
+      while (--NumTargets != 0)
+      {
+        ES_EventPool_Release(TheEvent.EventParam);
+      }
+    }
+    return false;
+  }
+  ES_AtomicSetBits(&Ready, ServiceMask); // show queues as non-empty
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Subscribe
+ Parameters
+   uint8_t : Which service is subscribing (index into ServDescList)
+   ES_EventType_t : the event type it wants to receive from ES_Publish
+ Returns
+   boolean : False if either parameter is out of range
+ Description
+   adds a service to the subscriber set for an event type
+ Notes
+   normally called from the service's init function with MyPriority
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_Subscribe(uint8_t WhichService, ES_EventType_t EventType)
+{
+  if ((WhichService >= NUM_SERVICES) || (EventType >= ES_NUM_EVENT_TYPES))
+  {
+    return false;
+  }
+  ES_AtomicSetBits(&Subscribers[EventType], BitNum2SetMask[WhichService]);
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Unsubscribe
+ Parameters
+   uint8_t : Which service is unsubscribing (index into ServDescList)
+   ES_EventType_t : the event type it no longer wants
+ Returns
+   boolean : False if either parameter is out of range
+ Description
+   removes a service from the subscriber set for an event type
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_Unsubscribe(uint8_t WhichService, ES_EventType_t EventType)
+{
+  if ((WhichService >= NUM_SERVICES) || (EventType >= ES_NUM_EVENT_TYPES))
+  {
+    return false;
+  }
+  ES_AtomicClrBits(&Subscribers[EventType], BitNum2SetMask[WhichService]);
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_Publish
+ Parameters
+   ES_Event : The Event to be published
+ Returns
+   boolean : False if the event could not be delivered to every subscriber
+ Description
+   posts the event to every service subscribed to its type, and only those
+ Notes
+   all-or-nothing, see ES_PostToServices. Publishing an event type that has
+   no subscribers succeeds and does nothing.
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_Publish(ES_Event_t ThisEvent)
+{
+  if (ThisEvent.EventType >= ES_NUM_EVENT_TYPES)
+  {
+    return false;
+  }
+  return ES_PostToServices(Subscribers[ThisEvent.EventType], ThisEvent);
+}
+
+#if ES_USE_EDF
+/****************************************************************************
+ Function
+   ES_SetDeadline
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+   ES_EventType_t : the event type the deadline applies to
+   uint16_t : relative deadline in ms from the time of the post, 0 removes
+              the declaration
+ Returns
+   boolean : False if the service or event type is out of range
+ Description
+   declares how soon after being posted an event of this type must be
+   dispatched to this service
+ Notes
+   normally called from the service's init function with MyPriority.
+   Events without a declared deadline are scheduled as if they had
+   ES_EDF_DEFAULT_DEADLINE and are not counted as misses.
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_SetDeadline(uint8_t WhichService, ES_EventType_t EventType,
+    uint16_t Deadline)
+{
+  if ((WhichService >= NUM_SERVICES) || (EventType >= ES_NUM_EVENT_TYPES))
+  {
+    return false;
+  }
+  RelDeadlines[WhichService][EventType] = Deadline;
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_GetDeadlineMisses
+ Parameters
+   uint8_t : Which service (index into ServDescList)
+ Returns
+   uint16_t : number of declared deadlines this service has missed
+ Description
+   a non-zero count means the schedule is not feasible for that service
+ Notes
+   the count saturates rather than wrapping
+ Author
+   Team, 10/17/26
+****************************************************************************/
+uint16_t ES_GetDeadlineMisses(uint8_t WhichService)
+{
+  if (WhichService >= NUM_SERVICES)
+  {
+    return 0;
+  }
+  return DeadlineMisses[WhichService];
+}
+#endif
+
 //*********************************
 // private functions
 //*********************************
+/****************************************************************************
+ Function
+   GetCoalesceMode
+ Parameters
+   ES_EventType_t : the type of the event being posted
+ Returns
+   ES_CoalesceMode_t : how posts of this type are merged
+ Description
+   looks up the coalescing mode for an event type
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+static ES_CoalesceMode_t GetCoalesceMode(ES_EventType_t EventType)
+{
+  if (EventType >= ES_NUM_EVENT_TYPES)
+  {
+    return ES_COALESCE_NONE;
+  }
+  return (ES_CoalesceMode_t)CoalesceModes[EventType];
+}
+
+#if ES_USE_EDF
+/****************************************************************************
+ Function
+   GetDeadline
+ Parameters
+   uint8_t : Which service
+   ES_EventType_t : type of the event
+ Returns
+   uint16_t : relative deadline in ms that applies to this service & event
+ Description
+   the declared deadline or ES_EDF_DEFAULT_DEADLINE if there is none
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+static uint16_t GetDeadline(uint8_t WhichService, ES_EventType_t EventType)
+{
+  uint16_t Deadline = 0;
+
+  if (EventType < ES_NUM_EVENT_TYPES)
+  {
+    Deadline = RelDeadlines[WhichService][EventType];
+  }
+  return (Deadline != 0) ? Deadline : ES_EDF_DEFAULT_DEADLINE;
+}
+
+/****************************************************************************
+ Function
+   SelectEarliestDeadline
+ Parameters
+   uint32_t : the Ready bits to choose from, must be non-zero
+ Returns
+   uint8_t : the service whose next event is due soonest
+ Description
+   looks at the event at the head of each ready queue and picks the one
+   with the least time left before its deadline
+ Notes
+   ties go to the higher priority service, since the search runs from the
+   top down and only a strictly earlier deadline replaces the choice. The
+   time arithmetic is done modulo 2^16 so it works across wrap of the tick
+   counter, as long as no event waits more than ~32s.
+ Author
+   Team, 10/17/26
+****************************************************************************/
+static uint8_t SelectEarliestDeadline(uint32_t ReadySet)
+{
+  uint8_t     Choice;
+  uint8_t     WhichService;
+  int16_t     Slack;
+  int16_t     LeastSlack = INT16_MAX;
+  uint16_t    Now = ES_Timer_GetTime();
+  ES_Event_t  HeadEvent;
+
+  // default to static priority, this also covers a lone stale ready bit
+  Choice = ES_GetMSBitSet(ReadySet);
+  while (ReadySet != 0)
+  {
+    WhichService = ES_GetMSBitSet(ReadySet);
+    ReadySet &= BitNum2ClrMask[WhichService];
+    if (ES_PeekQueue(EventQueues[WhichService].pMem, &HeadEvent))
+    {
+      Slack = (int16_t)((uint16_t)(HeadEvent.PostTime +
+          GetDeadline(WhichService, HeadEvent.EventType)) - Now);
+      if (Slack < LeastSlack)
+      {
+        LeastSlack  = Slack;
+        Choice      = WhichService;
+      }
+    }
+  }
+  return Choice;
+}
+
+/****************************************************************************
+ Function
+   CheckDeadline
+ Parameters
+   uint8_t : the service about to run
+   ES_Event_t : the event it is about to be handed
+ Returns
+   nothing
+ Description
+   counts a miss if the event had a declared deadline that has passed
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+static void CheckDeadline(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  uint16_t Deadline;
+
+  if ((ThisEvent.EventType >= ES_NUM_EVENT_TYPES) ||
+      (RelDeadlines[WhichService][ThisEvent.EventType] == 0))
+  {
+    return; // nothing declared, so nothing to miss
+  }
+  Deadline = ThisEvent.PostTime + RelDeadlines[WhichService][ThisEvent.EventType];
+  if (((int16_t)(ES_Timer_GetTime() - Deadline) > 0) &&
+      (DeadlineMisses[WhichService] != UINT16_MAX))
+  {
+    DeadlineMisses[WhichService]++;
+  }
+}
+#endif
+
 #if 0
 /****************************************************************************
  Function
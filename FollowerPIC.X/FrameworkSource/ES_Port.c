@@ -13,6 +13,20 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 18:40 Team    stack pointer check moved to _HW_StackCheck so it
+                        runs without ES_ISR_PROFILE; _HW_StackFault writes
+                        a fixed message to U1TXREG instead of DB_printf
+ 10/17/26 14:15 Team    added stack painting in _on_reset, an incremental
+                        high-water scan, maximum ISR nesting depth, a stack
+                        pointer check on profiled ISR entry and
+                        _HW_StackFault
+ 10/17/26 13:50 Team    added ISR profiling (execution time and entry jitter
+                        histograms per ISR), SysTick is profiled
+ 10/17/26 13:00 Team    added bottom halves run from _HW_Process_Pending_Ints.
+                       TickCount is now drained with an atomic exchange so a
+                       tick arriving during the decrement can't be lost
+ 10/17/26 12:10 Team    added _HW_Idle to WAIT when there is no work, and
+                        idle time accounting for a CPU utilisation figure
  08/06/21 15:43 jec     no changes just a test of using GIT from within MPLABX
  08/06/21 13:04 jec     cleaned things up in preparation for the 2021 AY
  10/05/20 18:52 ram     started work on port to PIC32MX170F256B
@@ -70,11 +84,15 @@
 #include <stdint.h>         // for exact size data types
 #include <stdbool.h>        // for the bool data type
 
+#include "ES_Configure.h"   // for the ISR profile table
 #include "ES_Port.h"        // the header file for this module
 #include "ES_Types.h"       // framework type definitions
 #include "ES_Timers.h"      // framework timer prototypes
+#include "ES_LookupTables.h" // for ES_GetMSBitSet
+#include "ES_General.h"     // for ARRAY_SIZE
 
 #include "terminal.h"       // terminal prototypes for init function
+#include "dbprintf.h"       // for the stack fault dump
 
 // TickCount is used to track the number of timer ints that have occurred
 // since the last check. It should really never be more than 1, but just to
@@ -83,13 +101,61 @@
 // need to post events from the interrupt response routine. This is necessary
 // for compilers like HTC for the midrange PICs which do not produce re-entrant
 // code so cannot post directly to the queues from within the interrupt resp.
-static volatile uint8_t TickCount;
+// It is a full word so that it can be taken and cleared atomically.
+static volatile uint32_t TickCount;
+
+// one bit for each raised bottom half, see _HW_RaiseBottomHalf in ES_Port.h
+volatile uint32_t _HW_PendingWork;
+// the handlers registered for each bottom half bit
+static BottomHalfFunc_t *BottomHalves[32];
 
 // Global tick count to monitor number of SysTick Interrupts
 // make uint16_t to maintain backwards compatibility and not overly burden
 // 8 and 16 bit processors
 static volatile uint16_t SysTickCounter = 0;
 
+// Idle accounting. Core timer counts spent in WAIT are summed over a window
+// of IDLE_WINDOW_COUNTS and the fraction is latched at the end of each one.
+// The core timer runs at 20MHz, so this is a 1 second window.
+#define IDLE_WINDOW_COUNTS 20000000UL
+static uint32_t IdleCounts;       // counts spent idle in the current window
+static uint32_t WindowStartCount; // core timer count at start of the window
+static uint8_t  LastIdlePercent;  // idle % over the last complete window
+
+#ifdef ES_ISR_PROFILE
+// ISR profiling, see ES_ISR_ENTER in ES_Port.h
+static const ES_ISRSlotDesc_t ISRSlots[] = { ISR_PROFILE_TABLE };
+static ES_ISRStats_t ISRStats[ARRAY_SIZE(ISRSlots)];
+static uint32_t ISRLastEntry[ARRAY_SIZE(ISRSlots)];
+
+// one frame for each ISR in progress. ISRs only nest by priority, so there
+// can be no more than one per IPL
+typedef struct
+{
+  uint32_t EntryCount;    // core timer at ES_ISR_ENTER
+  uint32_t NestedCycles;  // time taken by ISRs that preempted this one
+  uint8_t  WhichISR;
+}ISRFrame_t;
+static ISRFrame_t ISRStack[7];
+static uint8_t ISRDepth;
+static uint8_t MaxISRDepth;       // deepest nesting seen since reset
+
+static uint8_t HistogramBin(uint32_t Cycles);
+#endif
+
+#ifdef ES_STACK_MONITOR
+// linker symbols: _splim is the lowest address the stack may use (the top
+// of the heap), _stack its initial top
+extern uint32_t _splim[];
+extern uint32_t _stack[];
+// lowest word found written so far, and where the current scan has got to
+static uint32_t *StackLowWater;
+static uint32_t *StackScanPtr;
+static SafeStateFunc_t *SafeStateHandler;
+
+static uint32_t *GetStackPointer(void);
+#endif
+
 // Rate value that needs to be continually added to the compare register to 
 // ensure the interrupts occur periodically
 static volatile TimerRate_t tickPeriod; 
@@ -205,6 +271,7 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
   static uint32_t deltaTime; // static for speed
   static uint8_t intsThatShouldHaveHappened;
   
+  ES_ISR_ENTER(ISR_PROF_SYSTICK);
   // clear interrupt flag using the atomic write to the CLR version of the
   // interrupt flag register
   IFS0CLR = _IFS0_CTIF_MASK;
@@ -262,6 +329,7 @@ void __ISR(_CORE_TIMER_VECTOR, IPL3AUTO ) _HW_SysTickIntHandler(void)
   // Toggle debug line
   LATBbits.LATB15 = ~LATBbits.LATB15;
 #endif
+  ES_ISR_EXIT(ISR_PROF_SYSTICK);
 }
 
 /****************************************************************************
@@ -300,24 +368,577 @@ uint16_t _HW_GetTickCount(void)
      return true so that it can be used in the conditional while() loop in
      ES_Run. This way the test for pending interrupts get processed after every
      run function is called and even when there are no queues with events.
-     This routine could be expanded to process any other interrupt sources
-     that you would like to use to post events to the framework services.
+     It also runs the bottom halves raised by ISRs since the last pass.
+     It also rolls over the idle accounting window.
  Author
      J. Edward Carryer, 08/13/13 13:27
 ****************************************************************************/
 bool _HW_Process_Pending_Ints(void)
 {
+  uint32_t Now = _CP0_GET_COUNT();
+  uint32_t Ticks;
+  uint32_t Pending;
+  uint8_t  WhichBH;
+
+  // close out the idle measurement window. This is done here rather than in
+  // _HW_Idle so that the figure still updates when we are never idle
+  if ((Now - WindowStartCount) >= IDLE_WINDOW_COUNTS)
+  {
+    LastIdlePercent   = (uint8_t)(IdleCounts / ((Now - WindowStartCount) / 100));
+    IdleCounts        = 0;
+    WindowStartCount  = Now;
+  }
+
   // in the case where there was a long delay in getting to this function,
-  // multiple interrupts may have occurred (TickCount > 1), so process them all
-  while (TickCount > 0)
+  // multiple interrupts may have occurred (TickCount > 1), so process them all.
+  // Take the count and zero it in one step, a tick that arrives later is
+  // simply left for the next pass
+  Ticks = ES_AtomicExchange(&TickCount, 0);
+  while (Ticks > 0)
   {
     /* call the framework tick response to actually run the timers */
     ES_Timer_Tick_Resp();
-    TickCount--;
+    Ticks--;
+  }
+
+  // run the bottom halves raised since the last pass. Bits raised while
+  // these run are picked up on the next pass
+  Pending = ES_AtomicExchange(&_HW_PendingWork, 0);
+  while (Pending != 0)
+  {
+    WhichBH = ES_GetMSBitSet(Pending);
+    Pending &= BitNum2ClrMask[WhichBH];
+    if (BottomHalves[WhichBH] != (BottomHalfFunc_t *)0)
+    {
+      BottomHalves[WhichBH]();
+    }
   }
   return true;  // always return true to allow loop test in ES_Run to proceed
 }
 
+/****************************************************************************
+ Function
+     _HW_RegisterBottomHalf
+ Parameters
+     uint8_t WhichBH : bottom half number (0-31) from ES_Configure.h
+     BottomHalfFunc_t *Handler : function to run in task context
+ Returns
+     bool: false if WhichBH is out of range or already taken
+ Description
+     connects a handler to a bottom half bit. The ISR raises the bit with
+     _HW_RaiseBottomHalf(WhichBH)
+ Notes
+     call from the owning service's init function, before the ISR is enabled
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool _HW_RegisterBottomHalf(uint8_t WhichBH, BottomHalfFunc_t *Handler)
+{
+  if ((WhichBH >= ARRAY_SIZE(BottomHalves)) ||
+      (BottomHalves[WhichBH] != (BottomHalfFunc_t *)0))
+  {
+    return false;
+  }
+  BottomHalves[WhichBH] = Handler;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     _HW_Idle
+ Parameters
+     none
+ Returns
+     bool: true if the CPU waited, false if there was a tick or bottom half
+     to process
+ Description
+     puts the CPU into Idle mode with the WAIT instruction until the next
+     interrupt, and adds the time spent waiting to the idle accounting
+ Notes
+     Must be called with interrupts disabled, after checking that there are
+     no events ready. The interrupt controller still wakes the core from WAIT
+     with interrupts globally disabled, so a post that comes in between the
+     caller's check and the WAIT ends the WAIT at once rather than being
+     left until the next interrupt. The ISR runs when the caller re-enables
+     interrupts, so ISR time is not counted as idle.
+     The SysTick wakes us at least once per tick, so event checkers are
+     still polled at least that often.
+     OSCCONbits.SLPEN is left at its reset value of 0, so WAIT selects Idle
+     (peripherals keep running) rather than Sleep.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool _HW_Idle(void)
+{
+  uint32_t WaitStart;
+
+  if ((TickCount != 0) || (_HW_PendingWork != 0))
+  {
+    return false; // a tick or bottom half came in, go process it
+  }
+  WaitStart = _CP0_GET_COUNT();
+  _wait();
+  IdleCounts += _CP0_GET_COUNT() - WaitStart;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     _HW_GetIdlePercent
+ Parameters
+     none
+ Returns
+     uint8_t: percent of the last measurement window spent idle in WAIT
+ Description
+     100 minus this is the CPU utilisation of the framework and ISRs
+ Notes
+     the window is IDLE_WINDOW_COUNTS (1 second)
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint8_t _HW_GetIdlePercent(void)
+{
+  return LastIdlePercent;
+}
+
+#ifdef ES_ISR_PROFILE
+/****************************************************************************
+ Function
+     _HW_ISRProfileEnter
+ Parameters
+     uint8_t WhichISR : slot in ISR_PROFILE_TABLE
+ Returns
+     nothing
+ Description
+     records the entry time of an ISR and, for a periodic slot, how far the
+     time since its previous entry was from the expected period
+ Notes
+     call through ES_ISR_ENTER, first thing in the ISR. Interrupts are held
+     off for the few instructions it takes so a higher priority ISR cannot
+     push its frame half way through ours, and restored as they were.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _HW_ISRProfileEnter(uint8_t WhichISR)
+{
+  uint32_t Status = __builtin_disable_interrupts();
+  uint32_t Now = _CP0_GET_COUNT();
+  uint32_t Interval;
+  uint32_t Jitter;
+
+  if ((WhichISR < ARRAY_SIZE(ISRSlots)) && (ISRDepth < ARRAY_SIZE(ISRStack)))
+  {
+    if ((ISRSlots[WhichISR].Period != 0) && (ISRStats[WhichISR].NumCalls != 0))
+    {
+      Interval = Now - ISRLastEntry[WhichISR];
+      Jitter = (Interval > ISRSlots[WhichISR].Period) ?
+          (Interval - ISRSlots[WhichISR].Period) :
+          (ISRSlots[WhichISR].Period - Interval);
+      ISRStats[WhichISR].JitterHist[HistogramBin(Jitter)]++;
+      if (Jitter > ISRStats[WhichISR].MaxJitterCycles)
+      {
+        ISRStats[WhichISR].MaxJitterCycles = Jitter;
+      }
+    }
+    ISRLastEntry[WhichISR] = Now;
+
+    ISRStack[ISRDepth].EntryCount   = Now;
+    ISRStack[ISRDepth].NestedCycles = 0;
+    ISRStack[ISRDepth].WhichISR     = WhichISR;
+    ISRDepth++;
+    if (ISRDepth > MaxISRDepth)
+    {
+      MaxISRDepth = ISRDepth;
+    }
+  }
+  if (Status & _CP0_STATUS_IE_MASK)
+  {
+    __builtin_enable_interrupts();
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_ISRProfileExit
+ Parameters
+     uint8_t WhichISR : slot in ISR_PROFILE_TABLE, as given to the entry
+ Returns
+     nothing
+ Description
+     closes the frame opened by _HW_ISRProfileEnter and adds its execution
+     time, less the time of any ISRs that preempted it, to the histogram.
+     The whole time is charged to the ISR this one preempted, if any.
+ Notes
+     call through ES_ISR_EXIT, last thing in the ISR and before any return
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _HW_ISRProfileExit(uint8_t WhichISR)
+{
+  uint32_t Status = __builtin_disable_interrupts();
+  uint32_t Now = _CP0_GET_COUNT();
+  uint32_t Elapsed;
+  uint32_t Exec;
+
+  // an entry that did not fit on the stack has no frame to close
+  if ((ISRDepth > 0) && (ISRStack[ISRDepth - 1].WhichISR == WhichISR))
+  {
+    ISRDepth--;
+    Elapsed = Now - ISRStack[ISRDepth].EntryCount;
+    Exec    = Elapsed - ISRStack[ISRDepth].NestedCycles;
+
+    ISRStats[WhichISR].NumCalls++;
+    ISRStats[WhichISR].TotalExecCycles += Exec;
+    ISRStats[WhichISR].ExecHist[HistogramBin(Exec)]++;
+    if (Exec > ISRStats[WhichISR].MaxExecCycles)
+    {
+      ISRStats[WhichISR].MaxExecCycles = Exec;
+    }
+    if (ISRDepth > 0)
+    {
+      ISRStack[ISRDepth - 1].NestedCycles += Elapsed;
+    }
+  }
+  if (Status & _CP0_STATUS_IE_MASK)
+  {
+    __builtin_enable_interrupts();
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_GetNumISRSlots
+ Parameters
+     none
+ Returns
+     uint8_t: number of entries in ISR_PROFILE_TABLE
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint8_t _HW_GetNumISRSlots(void)
+{
+  return (uint8_t)ARRAY_SIZE(ISRSlots);
+}
+
+/****************************************************************************
+ Function
+     _HW_GetISRStats
+ Parameters
+     uint8_t WhichISR : slot in ISR_PROFILE_TABLE
+     ES_ISRStats_t *pStats : where to copy the slot's figures
+ Returns
+     const char *: the slot's name, or a null pointer if out of range
+ Description
+     copies a consistent snapshot of one slot's statistics
+ Notes
+     task level only, the copy is made inside a critical region
+ Author
+     Team, 10/17/26
+****************************************************************************/
+const char *_HW_GetISRStats(uint8_t WhichISR, ES_ISRStats_t *pStats)
+{
+  if (WhichISR >= ARRAY_SIZE(ISRSlots))
+  {
+    return (const char *)0;
+  }
+  EnterCritical();
+  *pStats = ISRStats[WhichISR];
+  ExitCritical();
+  return ISRSlots[WhichISR].Name;
+}
+
+/****************************************************************************
+ Function
+     _HW_ResetISRStats
+ Parameters
+     none
+ Returns
+     nothing
+ Description
+     clears every slot's statistics, to start a fresh measurement window
+ Notes
+     task level only. ISRs in progress keep their frames.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _HW_ResetISRStats(void)
+{
+  uint8_t i;
+  uint8_t Bin;
+
+  EnterCritical();
+  for (i = 0; i < ARRAY_SIZE(ISRSlots); i++)
+  {
+    ISRStats[i].NumCalls        = 0;
+    ISRStats[i].TotalExecCycles = 0;
+    ISRStats[i].MaxExecCycles   = 0;
+    ISRStats[i].MaxJitterCycles = 0;
+    for (Bin = 0; Bin < ES_ISR_HIST_BINS; Bin++)
+    {
+      ISRStats[i].ExecHist[Bin]   = 0;
+      ISRStats[i].JitterHist[Bin] = 0;
+    }
+  }
+  ExitCritical();
+}
+
+/****************************************************************************
+ Function
+     _HW_GetMaxISRDepth
+ Parameters
+     none
+ Returns
+     uint8_t: the most profiled ISRs that have been in progress at once
+ Notes
+     not cleared by _HW_ResetISRStats
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint8_t _HW_GetMaxISRDepth(void)
+{
+  return MaxISRDepth;
+}
+
+/****************************************************************************
+ Function
+     HistogramBin
+ Parameters
+     uint32_t Cycles : a time in core timer counts
+ Returns
+     uint8_t: its log2 histogram bin, see ES_ISR_HIST_BINS
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint8_t HistogramBin(uint32_t Cycles)
+{
+  uint8_t Bin;
+
+  if (Cycles == 0)
+  {
+    return 0;
+  }
+  Bin = ES_GetMSBitSet(Cycles) + 1;
+  return (Bin < ES_ISR_HIST_BINS) ? Bin : (ES_ISR_HIST_BINS - 1);
+}
+#endif /* ES_ISR_PROFILE */
+
+#ifdef ES_STACK_MONITOR
+/****************************************************************************
+ Function
+     _on_reset
+ Parameters
+     none
+ Returns
+     nothing
+ Description
+     paints the free stack with ES_STACK_PAINT so _HW_StackScanStep can
+     find how deep it has ever gone
+ Notes
+     called by the XC32 startup code before .data and .bss are initialised,
+     so it must not touch module variables. Stops 64 bytes below the stack
+     pointer to leave its own frame alone.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _on_reset(void)
+{
+  uint32_t *pWord = _splim;
+  uint32_t *pEnd = GetStackPointer() - 16;
+
+  while (pWord < pEnd)
+  {
+    *pWord++ = ES_STACK_PAINT;
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_StackScanStep
+ Parameters
+     uint32_t MaxWords : most words to examine in this call
+ Returns
+     bool: true when a scan from _splim has reached the high-water mark,
+     i.e. _HW_GetStackHighWater is up to date
+ Description
+     carries on the scan for the lowest word that is no longer paint. The
+     scan only has to cover the words below the lowest one found so far,
+     and restarts from _splim after each pass or when it finds a new low.
+ Notes
+     task level. Each word takes a few cycles, so 1024 words is about 100us.
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool _HW_StackScanStep(uint32_t MaxWords)
+{
+  if ((StackLowWater == (uint32_t *)0) || (StackScanPtr == (uint32_t *)0))
+  {
+    StackLowWater = _stack;
+    StackScanPtr  = _splim;
+  }
+  while ((MaxWords > 0) && (StackScanPtr < StackLowWater))
+  {
+    if (*StackScanPtr != ES_STACK_PAINT)
+    {
+      StackLowWater = StackScanPtr;
+      break;
+    }
+    StackScanPtr++;
+    MaxWords--;
+  }
+  if ((MaxWords == 0) && (StackScanPtr < StackLowWater))
+  {
+    return false; // more to scan
+  }
+  StackScanPtr = _splim;
+  return true;
+}
+
+/****************************************************************************
+ Function
+     _HW_GetStackSize
+ Parameters
+     none
+ Returns
+     uint32_t: bytes between _splim and the initial stack pointer
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t _HW_GetStackSize(void)
+{
+  return (uint32_t)((uint8_t *)_stack - (uint8_t *)_splim);
+}
+
+/****************************************************************************
+ Function
+     _HW_GetStackHighWater
+ Parameters
+     none
+ Returns
+     uint32_t: most bytes of stack in use at any time, as found by the last
+     completed _HW_StackScanStep pass
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t _HW_GetStackHighWater(void)
+{
+  if (StackLowWater == (uint32_t *)0)
+  {
+    return 0;
+  }
+  return (uint32_t)((uint8_t *)_stack - (uint8_t *)StackLowWater);
+}
+
+/****************************************************************************
+ Function
+     _HW_SetSafeStateHandler
+ Parameters
+     SafeStateFunc_t *Handler : puts the hardware in a safe state
+ Returns
+     nothing
+ Description
+     registers the function _HW_StackFault calls before it halts, e.g. to
+     turn the motor drives off
+ Notes
+     the handler runs with interrupts off and must not use the framework
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _HW_SetSafeStateHandler(SafeStateFunc_t *Handler)
+{
+  SafeStateHandler = Handler;
+}
+
+/****************************************************************************
+ Function
+     _HW_StackCheck
+ Parameters
+     none
+ Returns
+     nothing
+ Description
+     halts through _HW_StackFault if the stack pointer is within
+     ES_STACK_GUARD_BYTES of _splim
+ Notes
+     called through ES_ISR_ENTER: ISR entries are where the stack goes
+     deepest, so look there rather than wait for the next high-water scan
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void _HW_StackCheck(void)
+{
+  if ((uint8_t *)GetStackPointer() <
+      ((uint8_t *)_splim + ES_STACK_GUARD_BYTES))
+  {
+    _HW_StackFault("stack pointer in guard band on ISR entry");
+  }
+}
+
+/****************************************************************************
+ Function
+     _HW_StackFault
+ Parameters
+     const char *Why : reason, a string constant
+ Returns
+     never
+ Description
+     stops everything, puts the hardware in a safe state, then writes
+     "Stack fault: " and Why to UART1 and stays there
+ Notes
+     the stack is nearly gone, so nothing here may go deeper than a frame
+     or two: no DB_printf or terminal buffer, the bytes go straight into
+     U1TXREG, and only if the UART has been set up
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void __attribute__((noreturn)) _HW_StackFault(const char *Why)
+{
+  static const char Banner[] = "\r\nStack fault: ";
+  const char *pChar;
+
+  __builtin_disable_interrupts();
+  if (SafeStateHandler != (SafeStateFunc_t *)0)
+  {
+    SafeStateHandler();
+  }
+
+  if (U1MODEbits.ON && U1STAbits.UTXEN)
+  {
+    for (pChar = Banner; *pChar != '\0'; pChar++)
+    {
+      while (U1STAbits.UTXBF)
+      {}
+      U1TXREG = *pChar;
+    }
+    for (pChar = Why; *pChar != '\0'; pChar++)
+    {
+      while (U1STAbits.UTXBF)
+      {}
+      U1TXREG = *pChar;
+    }
+  }
+  while (1)
+  {}
+}
+
+/****************************************************************************
+ Function
+     GetStackPointer
+ Parameters
+     none
+ Returns
+     uint32_t *: the current stack pointer
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint32_t *GetStackPointer(void)
+{
+  uint32_t *StackPointer;
+
+  __asm__ volatile ("move %0, $sp" : "=r" (StackPointer));
+  return StackPointer;
+}
+#endif /* ES_STACK_MONITOR */
+
 /****************************************************************************
  Function
      _HW_ConsoleInit
@@ -9,6 +9,15 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 15:30 Team     ES_COALESCE_DUPLICATES only compares with the newest
+                         pending entry, so A,B,A is no longer delivered as A,B
+ 10/17/26 11:45 Team     added ES_PeekQueue. A coalesced event keeps the
+                         PostTime of the event it replaces
+ 10/17/26 10:55 Team     added coalescing enqueue, a pending event that matches
+                         the new one is overwritten in place rather than
+                         taking another slot. Multi takes a coalesce mode too
+ 10/17/26 10:05 Team     added ES_EnQueueFIFOMulti for all-or-nothing posts
+                         to several queues under one critical region
  01/15/12 09:34 jec      converted to use the new C99 types from types.h
  08/09/11 18:16 jec      started coding
 *****************************************************************************/
@@ -32,6 +41,8 @@ typedef struct
 typedef ES_Queue_t *pQueue_t;
 
 /*---------------------------- Module Functions ---------------------------*/
+static ES_Event_t *FindPending(ES_Event_t *pBlock, ES_Event_t Event2Match,
+    ES_CoalesceMode_t Mode);
 
 /*---------------------------- Module Variables ---------------------------*/
 
@@ -104,6 +115,98 @@ bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add)
   }
 }
 
+/****************************************************************************
+ Function
+   ES_EnQueueFIFOMulti
+ Parameters
+   ES_Event * const * pBlocks : array of pointers to the Queue blocks
+   uint8_t NumBlocks : number of entries in pBlocks
+   ES_Event Event2Add : event to be added to each of the Queues
+   ES_CoalesceMode_t Mode : how to treat a matching event already pending,
+          ES_COALESCE_NONE always takes a new slot
+ Returns
+   bool : true if the event was added to every Queue, false if it was
+          added to none of them
+ Description
+   adds Event2Add to all of the listed Queues or, if any one of them is full,
+   to none of them
+ Notes
+   the space test and the adds are done inside a single critical region so
+   that an ISR can not fill one of the Queues part way through
+ Author
+   Team, 10/17/26, 10:05
+****************************************************************************/
+bool ES_EnQueueFIFOMulti(ES_Event_t *const *pBlocks, uint8_t NumBlocks,
+    ES_Event_t Event2Add, ES_CoalesceMode_t Mode)
+{
+  pQueue_t    pThisQueue;
+  ES_Event_t  *pPending;
+  uint8_t     i;
+
+  EnterCritical();  // save interrupt state, turn ints off
+  // first pass: make sure there is room everywhere before touching anything
+  // a queue holding a matching event has room since it will be overwritten
+  for (i = 0; i < NumBlocks; i++)
+  {
+    pThisQueue = (pQueue_t)pBlocks[i];
+    if ((pThisQueue->NumEntries >= pThisQueue->QueueSize) &&
+        (FindPending(pBlocks[i], Event2Add, Mode) == (ES_Event_t *)0))
+    {
+      ExitCritical();
+      return false;
+    }
+  }
+  // second pass: now we know that all of the adds will succeed
+  for (i = 0; i < NumBlocks; i++)
+  {
+    pPending = FindPending(pBlocks[i], Event2Add, Mode);
+    if (pPending != (ES_Event_t *)0)
+    {
+#if ES_USE_EDF
+      // the pending event has been waiting longer, keep its deadline
+      Event2Add.PostTime = pPending->PostTime;
+#endif
+      *pPending = Event2Add;
+    }
+    else
+    {
+      pThisQueue = (pQueue_t)pBlocks[i];
+      pBlocks[i][1 + ((pThisQueue->CurrentIndex + pThisQueue->NumEntries)
+          % pThisQueue->QueueSize)] = Event2Add;
+      pThisQueue->NumEntries++;
+    }
+  }
+  ExitCritical();    // restore saved interrupt state
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_EnQueueFIFOCoalesce
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Add : event to be added to the Queue
+   ES_CoalesceMode_t Mode : what counts as a matching pending event
+ Returns
+   bool : true if the event was added or merged, false if the Queue was full
+          and held no matching event
+ Description
+   like ES_EnQueueFIFO, except that if an event matching Event2Add is still
+   waiting in the Queue, it is overwritten in place with Event2Add.
+   ES_COALESCE_LATEST matches on EventType alone (latest value wins),
+   ES_COALESCE_DUPLICATES matches only an identical EventType & EventParam
+ Notes
+   the pending event keeps its place in the Queue, so a burst costs one slot
+   and one dispatch
+ Author
+   Team, 10/17/26, 10:55
+****************************************************************************/
+bool ES_EnQueueFIFOCoalesce(ES_Event_t *pBlock, ES_Event_t Event2Add,
+    ES_CoalesceMode_t Mode)
+{
+  return ES_EnQueueFIFOMulti(&pBlock, 1, Event2Add, Mode);
+}
+
 /****************************************************************************
  Function
    ES_EnQueueLIFO
@@ -205,6 +308,38 @@ uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent)
   return NumLeft;
 }
 
+/****************************************************************************
+ Function
+   ES_PeekQueue
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event * pReturnEvent : used to return a copy of the next event
+ Returns
+   bool : true if there was an event to copy, false if the Queue was empty
+ Description
+   copies the event that the next ES_DeQueue would return, without
+   removing it
+ Notes
+
+ Author
+   Team, 10/17/26, 11:45
+****************************************************************************/
+bool ES_PeekQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent)
+{
+  pQueue_t  pThisQueue;
+  bool      HaveEvent;
+
+  pThisQueue = (pQueue_t)pBlock;
+  EnterCritical();  // save interrupt state, turn ints off
+  HaveEvent = (pThisQueue->NumEntries > 0);
+  if (HaveEvent)
+  {
+    *pReturnEvent = pBlock[1 + pThisQueue->CurrentIndex];
+  }
+  ExitCritical();    // restore saved interrupt state
+  return HaveEvent;
+}
+
 /****************************************************************************
  Function
    ES_IsQueueEmpty
@@ -227,6 +362,69 @@ bool ES_IsQueueEmpty(ES_Event_t *pBlock)
   return pThisQueue->NumEntries == 0;
 }
 
+//*********************************
+// private functions
+//*********************************
+/****************************************************************************
+ Function
+   FindPending
+ Parameters
+   ES_Event * pBlock : pointer to the block of memory in use as the Queue
+   ES_Event Event2Match : the event being posted
+   ES_CoalesceMode_t Mode : what counts as a match
+ Returns
+   pointer to the matching pending entry, or NULL if there is none
+ Description
+   ES_COALESCE_LATEST searches all the entries still waiting in the Queue
+   for one of the same type. ES_COALESCE_DUPLICATES only looks at the
+   newest entry, so a copy posted after some other event is kept and the
+   order of delivery is unchanged.
+ Notes
+   must be called with interrupts off. Queues are only a few entries long
+   so the linear search is short.
+ Author
+   Team, 10/17/26, 10:55
+****************************************************************************/
+static ES_Event_t *FindPending(ES_Event_t *pBlock, ES_Event_t Event2Match,
+    ES_CoalesceMode_t Mode)
+{
+  pQueue_t    pThisQueue;
+  ES_Event_t  *pEntry;
+  uint8_t     i;
+
+  if (Mode == ES_COALESCE_NONE)
+  {
+    return (ES_Event_t *)0;
+  }
+  pThisQueue = (pQueue_t)pBlock;
+  if (Mode == ES_COALESCE_DUPLICATES)
+  {
+    if (pThisQueue->NumEntries == 0)
+    {
+      return (ES_Event_t *)0;
+    }
+    pEntry = &pBlock[1 + ((pThisQueue->CurrentIndex +
+        pThisQueue->NumEntries - 1) % pThisQueue->QueueSize)];
+    if ((pEntry->EventType == Event2Match.EventType) &&
+        (pEntry->EventParam == Event2Match.EventParam))
+    {
+      return pEntry;
+    }
+    return (ES_Event_t *)0;
+  }
+  for (i = 0; i < pThisQueue->NumEntries; i++)
+  {
+    pEntry = &pBlock[1 + ((pThisQueue->CurrentIndex + i)
+        % pThisQueue->QueueSize)];
+    if ((pEntry->EventType == Event2Match.EventType) &&
+        (Mode == ES_COALESCE_LATEST))
+    {
+      return pEntry;
+    }
+  }
+  return (ES_Event_t *)0;
+}
+
 #if 0
 /****************************************************************************
  Function
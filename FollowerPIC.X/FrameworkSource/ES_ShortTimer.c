@@ -1,70 +1,74 @@
-//#define DEBUG
 /****************************************************************************
  Module
    ES_ShortTimer.c
 
  Revision
-   1.0.1
+   2.0.0
 
  Description
    This is a library to provide for the creation of short time-outs
    (shorter than the resolution of the ES_Timer library).
 
  Notes
-   This module uses the Tiva Peripheral Driver Library functions and
-   the ability that it provides to 'hook' a function into an interrupt
-   response routine without modifying the vector table directly.
-   Uses timers A & B on 16/32 bit Timer Module 5
+   Two one-shot channels with 1uS timeout units, TIMER_A on Timer1 and
+   TIMER_B on Timer5, neither of which is used elsewhere. Both count PBCLK
+   (20MHz) / 8, so a count is 0.4uS. A timeout longer than one 16 bit
+   period (26.2mS) is run as several periods. Expiry is handed from the
+   IPL4 ISR to a bottom half, which posts ES_SHORT_TIMEOUT with the channel
+   number as the EventParam, so the ISRs never take the queue critical
+   regions. Add the timeout to the time of the ISR entry (about 1uS) and
+   the latency of the event dispatch to get when the service runs.
 
  History
  When           Who     What/Why
  -------------- ---     --------
- 10/11/15 10:30 jec     first pass
+ 10/17/26 15:05 Team    ported to the PIC32: Timer1 & Timer5, timeouts past
+                        one timer period, posting from a bottom half,
+                        ES_ShortTimerStop
  10/11/15 18:10 jec     converted to post events to the framework
+ 10/11/15 10:30 jec     first pass
 
 ****************************************************************************/
-// the common headers for I/O, C99 types
-#include <stdio.h>
+// the common headers for C99 types
 #include <stdint.h>
 #include <stdbool.h>
-#include "BITDEFS.H"
-
-// the headers to access the GPIO subsystem
-#include "inc/hw_memmap.h"
-#include "inc/hw_types.h"
-#include "inc/hw_gpio.h"
-#include "inc/hw_sysctl.h"
-#include "inc/hw_timer.h"
-#include "inc/hw_ints.h"
-
-// the headers to access the TivaWare Library
-#include "driverlib/sysctl.h"
-#include "driverlib/pin_map.h"
-#include "driverlib/gpio.h"
-#include "driverlib/timer.h"
-#include "driverlib/interrupt.h"
+
+// the hardware
+#include <xc.h>
+#include <sys/attribs.h>
 
 // the header to get the timing functions
 #include "ES_ShortTimer.h"
 
 // the framework headers
-#include "ES_Framework.h"
 #include "ES_Configure.h"
+#include "ES_Framework.h"
 
-// module level functions
-
-// define for the timer pre-scaler. this sets the resolution of the
-// timing functions
-// the current values are based on a 40mHz clock rate to give 1uS resolution
-#define PRE_1uS 40
+// Timer1 and Timer5 run at PBCLK / 8, which is 2.5 counts per uS
+#define PRESCALE_8_TYPE_A   0b01    // TCKPS for Timer1
+#define PRESCALE_8_TYPE_B   0b011   // TCKPS for Timer5
+#define COUNTS_PER_2uS      5u
+// a period of n counts is loaded as PR = n - 1
+#define MAX_PERIOD_COUNTS   0x10000UL
+// shorter timeouts than this are over before the ISR could run, post now
+#define MIN_TIMEOUT_uS      3u
+#define SHORT_TIMER_IPL     4
 
-void ShortTimerAHandler(void);
-void ShortTimerBHandler(void);
+// module level functions
+static void LoadPeriod(uint8_t Which, uint32_t Counts);
+static void ShortTimerBottomHalf(void);
 
 // module level variables
 
-static uint8_t  Timer_A_Priority  = SHORT_TIMER_UNUSED;
-static uint8_t  Timer_B_Priority  = SHORT_TIMER_UNUSED;
+static uint8_t  TimerPriority[SHORT_TIMER_NUM_CHANNELS] =
+{
+  SHORT_TIMER_UNUSED, SHORT_TIMER_UNUSED
+};
+// counts still to run after the period now loaded, one owner at a time:
+// ES_ShortTimerStart with the channel's interrupt off, else its ISR
+static uint32_t CountsLeft[SHORT_TIMER_NUM_CHANNELS];
+// one bit per channel that has expired, drained by ShortTimerBottomHalf
+static volatile uint32_t ExpiredChannels = 0;
 
 //******************************
 // ES_ShortTimerInit()
@@ -73,115 +77,184 @@ static uint8_t  Timer_B_Priority  = SHORT_TIMER_UNUSED;
 //******************************
 void ES_ShortTimerInit(uint8_t TimeAPrio, uint8_t TimeBPrio)
 {
-#ifdef DEBUG
-// set up I/O lines for debugging
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-  GPIOPinTypeGPIOOutput(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-// start with the lines low
-  GPIOPinWrite(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1, BIT0LO & BIT1LO);
-#endif
-
-// enable the clock to the timer module
-  SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER5);
-// configure as 2 16 bit timers
-  TimerConfigure(TIMER5_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_ONE_SHOT |
-      TIMER_CFG_B_ONE_SHOT);
-// set prescale to get 1uS resolution
-  TimerPrescaleSet(TIMER5_BASE, TIMER_BOTH, PRE_1uS);
-// log the service to which the timeout will be posted
-  Timer_A_Priority  = TimeAPrio;
-  Timer_B_Priority  = TimeBPrio;
+  ES_ShortTimerStop(TIMER_A);
+  ES_ShortTimerStop(TIMER_B);
+
+  // Timer1: PBCLK source, 1:8, no gating
+  T1CONbits.TCS   = 0;
+  T1CONbits.TGATE = 0;
+  T1CONbits.TCKPS = PRESCALE_8_TYPE_A;
+  IPC1bits.T1IP   = SHORT_TIMER_IPL;
+  IPC1bits.T1IS   = 0;
+
+  // Timer5: PBCLK source, 1:8, no gating
+  T5CONbits.TCS   = 0;
+  T5CONbits.TGATE = 0;
+  T5CONbits.TCKPS = PRESCALE_8_TYPE_B;
+  IPC5bits.T5IP   = SHORT_TIMER_IPL;
+  IPC5bits.T5IS   = 0;
+
+  // only the first call can register, the handler is the same anyway
+  _HW_RegisterBottomHalf(BH_SHORT_TIMER, ShortTimerBottomHalf);
+
+  // log the service to which the timeout will be posted
+  TimerPriority[TIMER_A] = TimeAPrio;
+  TimerPriority[TIMER_B] = TimeBPrio;
 }
 
-void ES_ShortTimerStart(uint32_t Which, uint16_t TimeoutValue)
+//******************************
+// ES_ShortTimerStart()
+// Start (or restart) channel Which to post ES_SHORT_TIMEOUT after
+// TimeoutValue uS. A restart replaces the running timeout, and drops one
+// that has expired but not yet been posted.
+//******************************
+void ES_ShortTimerStart(uint8_t Which, uint16_t TimeoutValue)
 {
-  if ((Which != TIMER_A) && (Which != TIMER_B))
+  if (Which >= SHORT_TIMER_NUM_CHANNELS)
   {
     return;
   }
-  // for very short delays. just immediatly post. There is 10us of overhead
-  if (TimeoutValue < 11)
+  ES_ShortTimerStop(Which);
+
+  // for very short delays, just post
+  if (TimeoutValue < MIN_TIMEOUT_uS)
   {
-    if (Which == TIMER_A)
-    {
-      ShortTimerAHandler();
-    }
-    else
-    {
-      ShortTimerBHandler();
-    }
+    ES_AtomicSetBits(&ExpiredChannels, (1UL << Which));
+    _HW_RaiseBottomHalf(BH_SHORT_TIMER);
+    return;
   }
-  TimerLoadSet(TIMER5_BASE, Which, TimeoutValue);
+  LoadPeriod(Which, ((uint32_t)TimeoutValue * COUNTS_PER_2uS) / 2u);
+}
 
-  if (Which == TIMER_A) // local enable
+//******************************
+// ES_ShortTimerStop()
+// Stop channel Which without posting. A timeout that has already expired
+// but not yet been posted is dropped as well.
+//******************************
+void ES_ShortTimerStop(uint8_t Which)
+{
+  if (Which == TIMER_A)
+  {
+    IEC0CLR = _IEC0_T1IE_MASK;
+    T1CONbits.ON = 0;
+    IFS0CLR = _IFS0_T1IF_MASK;
+  }
+  else if (Which == TIMER_B)
   {
-    TimerIntEnable(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
-    // NVIC Enable
-    IntEnable(INT_TIMER5A_TM4C123);
+    IEC0CLR = _IEC0_T5IE_MASK;
+    T5CONbits.ON = 0;
+    IFS0CLR = _IFS0_T5IF_MASK;
   }
   else
   {
-    // local enable
-    TimerIntEnable(TIMER5_BASE, TIMER_TIMB_TIMEOUT);
-    // NVIC Enable
-    IntEnable(INT_TIMER5B_TM4C123);
+    return;
   }
+  CountsLeft[Which] = 0;
+  ES_AtomicClrBits(&ExpiredChannels, (1UL << Which));
+}
 
-  TimerEnable(TIMER5_BASE, Which);
+//******************************
+// ShortTimerAISR()
+// Timer1 period match: load the next period or mark TIMER_A expired
+//******************************
+void __ISR(_TIMER_1_VECTOR, IPL4SOFT) ShortTimerAISR(void)
+{
+  ES_ISR_ENTER(ISR_PROF_SHORT_A);
 
-#ifdef DEBUG
-// raise I/O line to show we started
-  if (Which == TIMER_A)
+  // start by clearing the source of the interrupt
+  IFS0CLR = _IFS0_T1IF_MASK;
+
+  if (CountsLeft[TIMER_A] != 0)
   {
-    GPIOPinWrite(GPIO_PORTB_BASE, BIT0HI, BIT0HI);
+    LoadPeriod(TIMER_A, CountsLeft[TIMER_A]);
   }
   else
   {
-    GPIOPinWrite(GPIO_PORTB_BASE, BIT1HI, BIT1HI);
+    T1CONbits.ON = 0;
+    IEC0CLR = _IEC0_T1IE_MASK;
+    ES_AtomicSetBits(&ExpiredChannels, (1UL << TIMER_A));
+    _HW_RaiseBottomHalf(BH_SHORT_TIMER);
   }
-#endif
-  return;
+
+  ES_ISR_EXIT(ISR_PROF_SHORT_A);
 }
 
-void ShortTimerAHandler(void)
+//******************************
+// ShortTimerBISR()
+// Timer5 period match: load the next period or mark TIMER_B expired
+//******************************
+void __ISR(_TIMER_5_VECTOR, IPL4SOFT) ShortTimerBISR(void)
 {
-  ES_Event_t ThisEvent;
+  ES_ISR_ENTER(ISR_PROF_SHORT_B);
+
+  // start by clearing the source of the interrupt
+  IFS0CLR = _IFS0_T5IF_MASK;
+
+  if (CountsLeft[TIMER_B] != 0)
+  {
+    LoadPeriod(TIMER_B, CountsLeft[TIMER_B]);
+  }
+  else
+  {
+    T5CONbits.ON = 0;
+    IEC0CLR = _IEC0_T5IE_MASK;
+    ES_AtomicSetBits(&ExpiredChannels, (1UL << TIMER_B));
+    _HW_RaiseBottomHalf(BH_SHORT_TIMER);
+  }
 
-// start by clearing the source of the interrupt
-  TimerIntClear(TIMER5_BASE, TIMER_TIMA_TIMEOUT);
-#ifdef DEBUG
-// lower I/O line to show we arrived
-  GPIOPinWrite(GPIO_PORTB_BASE, BIT0HI, BIT0LO);
-#endif
-
-// post the timeout for this timer
-  ThisEvent.EventType   = ES_SHORT_TIMEOUT;
-  ThisEvent.EventParam  = TIMER_A;
-// protect against timer that was not correctly initialized
-  if (Timer_A_Priority != SHORT_TIMER_UNUSED)
+  ES_ISR_EXIT(ISR_PROF_SHORT_B);
+}
+
+//******************************
+// LoadPeriod()
+// Run channel Which for the next (up to MAX_PERIOD_COUNTS) of Counts,
+// from a cleared timer, with its interrupt enabled. The caller owns the
+// channel: its ISR, or task level with the interrupt disabled.
+//******************************
+static void LoadPeriod(uint8_t Which, uint32_t Counts)
+{
+  uint32_t Period = (Counts > MAX_PERIOD_COUNTS) ? MAX_PERIOD_COUNTS : Counts;
+
+  CountsLeft[Which] = Counts - Period;
+  if (Which == TIMER_A)
   {
-    ES_PostToService(Timer_A_Priority, ThisEvent);
+    T1CONbits.ON = 0;
+    TMR1 = 0;
+    PR1 = Period - 1;
+    IFS0CLR = _IFS0_T1IF_MASK;
+    IEC0SET = _IEC0_T1IE_MASK;
+    T1CONbits.ON = 1;
+  }
+  else
+  {
+    T5CONbits.ON = 0;
+    TMR5 = 0;
+    PR5 = Period - 1;
+    IFS0CLR = _IFS0_T5IF_MASK;
+    IEC0SET = _IEC0_T5IE_MASK;
+    T5CONbits.ON = 1;
   }
 }
 
-void ShortTimerBHandler(void)
+//******************************
+// ShortTimerBottomHalf()
+// Post ES_SHORT_TIMEOUT for each channel that has expired
+//******************************
+static void ShortTimerBottomHalf(void)
 {
   ES_Event_t ThisEvent;
+  uint32_t   Expired = ES_AtomicExchange(&ExpiredChannels, 0);
+  uint8_t    Which;
 
-// start by clearing the source of the interrupt
-  TimerIntClear(TIMER5_BASE, TIMER_TIMB_TIMEOUT);
-#ifdef DEBUG
-// lower I/O line to show we arrived
-  GPIOPinWrite(GPIO_PORTB_BASE, BIT1HI, BIT1LO);
-#endif
-
-// post the timeout for this timer
-  ThisEvent.EventType   = ES_SHORT_TIMEOUT;
-  ThisEvent.EventParam  = TIMER_B;
-// protect against timer that was not correctly initialized
-  if (Timer_B_Priority != SHORT_TIMER_UNUSED)
+  ThisEvent.EventType = ES_SHORT_TIMEOUT;
+  for (Which = 0; Which < SHORT_TIMER_NUM_CHANNELS; Which++)
   {
-    ES_PostToService(Timer_B_Priority, ThisEvent);
+    // protect against timer that was not correctly initialized
+    if ((Expired & (1UL << Which)) &&
+        (TimerPriority[Which] != SHORT_TIMER_UNUSED))
+    {
+      ThisEvent.EventParam = Which;
+      ES_PostToService(TimerPriority[Which], ThisEvent);
+    }
   }
 }
-
@@ -14,6 +14,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    Check4Keystroke publishes ES_NEW_KEY to subscribers
+                        instead of posting it to every service
  02/03/26       Tianyu  Initial creation for Lab 8 event checkers
 ****************************************************************************/
 
@@ -42,7 +44,8 @@
 
  Description
    checks to see if a new key from the keyboard is detected and, if so,
-   retrieves the key and posts an ES_NEW_KEY event to TestHarnessService0
+   retrieves the key and publishes an ES_NEW_KEY event to the services that
+   subscribed to it (TestHarnessService0)
 
  Notes
    The functions that actually check the serial hardware for characters
@@ -58,7 +61,7 @@ bool Check4Keystroke(void)
     ES_Event_t ThisEvent;
     ThisEvent.EventType   = ES_NEW_KEY;
     ThisEvent.EventParam  = GetNewKey();
-    ES_PostAll(ThisEvent);
+    ES_Publish(ThisEvent);
     return true;
   }
   return false;
@@ -19,6 +19,9 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    RxRing volatile, ordered with the RxHead publish
+ 10/17/26       Team    SPI ISR queues received bytes for a bottom half
+                        rather than posting from the ISR
  02/17/26       Tianyu  Initial creation for Leader-Follower architecture
 ****************************************************************************/
 
@@ -35,9 +38,13 @@
 #include <xc.h>
 
 /*----------------------------- Module Defines ----------------------------*/
+// Bytes the SPI ISR can hold for the bottom half, must be a power of 2.
+// The leader queries every few ms, so a handful covers a slow pass.
+#define RX_RING_SIZE 8
 
 /*---------------------------- Module Functions ---------------------------*/
 void __ISR(_SPI_1_VECTOR, IPL7SOFT) SPI_ISR(void);
+static void SPIRxBottomHalf(void);
 
 /*---------------------------- Module Variables ---------------------------*/
 static uint8_t MyPriority;
@@ -46,6 +53,16 @@ static uint8_t CurrentStatus = 0x00;  // Current status to send
 static bool NewStatusFlag = false;    // Flag indicating new status pending
 static uint8_t LastSideCommand = CMD_SIDE_MIDDLE;  // Track last side servo command
 
+// Received bytes from the SPI ISR to SPIRxBottomHalf. Single producer, single
+// consumer: only the ISR writes RxHead, only the bottom half writes RxTail,
+// so no critical region is needed. The indices run free and are masked.
+// The ring is volatile too, so the byte store cannot be moved after the
+// RxHead store that publishes it, nor the bottom half's read cached.
+static volatile uint8_t RxRing[RX_RING_SIZE];
+static volatile uint8_t RxHead;
+static volatile uint8_t RxTail;
+static volatile uint8_t RxOverruns;   // bytes dropped with the ring full
+
 /*------------------------------ Module Code ------------------------------*/
 
 /****************************************************************************
@@ -116,6 +133,10 @@ bool InitSPIFollowerFSM(uint8_t Priority)
   SPISetup_SetXferWidth(SPI_SPI1, SPI_8BIT);
   
   // Configure interrupts
+
+  // The SPI ISR hands received bytes to us through a bottom half
+  RxHead = RxTail = 0;
+  _HW_RegisterBottomHalf(BH_SPI_COMMAND, SPIRxBottomHalf);
   
   // Clear SPI Fault, SPI Receive Done, SPI Transfer Done
   IFS1CLR = _IFS1_SPI1EIF_MASK | _IFS1_SPI1RXIF_MASK | _IFS1_SPI1TXIF_MASK;
@@ -401,11 +422,17 @@ void __ISR(_SPI_1_VECTOR, IPL7SOFT) SPI_ISR(void)
   // Clear interrupt flag
   IFS1CLR = _IFS1_SPI1RXIF_MASK;
 
-  // Post an event to itself to indicate a new SPI command has been retrieved
-  ES_Event_t ThisEvent;
-  ThisEvent.EventType = ES_COMMAND_RETRIEVED;
-  ThisEvent.EventParam = receivedData; // Include received data so we know the leader's command
-  PostSPIFollowerFSM(ThisEvent);
+  // Queue the byte for SPIRxBottomHalf, which posts ES_COMMAND_RETRIEVED
+  if ((uint8_t)(RxHead - RxTail) < RX_RING_SIZE)
+  {
+    RxRing[RxHead & (RX_RING_SIZE - 1)] = receivedData;
+    RxHead++;
+  }
+  else
+  {
+    RxOverruns++;
+  }
+  _HW_RaiseBottomHalf(BH_SPI_COMMAND);
   
   // Determine what to send based on current state
   if (CurrentState == SendingNewFlag)
@@ -435,5 +462,36 @@ void __ISR(_SPI_1_VECTOR, IPL7SOFT) SPI_ISR(void)
  private functions
  ***************************************************************************/
 
+/****************************************************************************
+ Function
+     SPIRxBottomHalf
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Bottom half of SPI_ISR, run by _HW_Process_Pending_Ints. Posts an
+     ES_COMMAND_RETRIEVED for each byte the ISR queued, oldest first.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void SPIRxBottomHalf(void)
+{
+  ES_Event_t ThisEvent;
+  ThisEvent.EventType = ES_COMMAND_RETRIEVED;
+
+  while (RxTail != RxHead)
+  {
+    // Include received data so we know the leader's command
+    ThisEvent.EventParam = RxRing[RxTail & (RX_RING_SIZE - 1)];
+    RxTail++;
+    PostSPIFollowerFSM(ThisEvent);
+  }
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
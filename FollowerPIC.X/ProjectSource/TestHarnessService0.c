@@ -14,6 +14,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    'u' key also prints event checker costs
+ 10/17/26       Team    added 'u' key to print CPU utilisation
  10/26/17 18:26 jec     moves definition of ALL_BITS to ES_Port.h
  10/19/17 21:28 jec     meaningless change to test updating
  10/19/17 18:42 jec     removed referennces to driverlib and programmed the
@@ -39,6 +41,7 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "ES_DeferRecall.h"
+#include "ES_CheckEvents.h"
 #include "ES_Port.h"
 #include "terminal.h"
 #include "dbprintf.h"
@@ -100,6 +103,8 @@ bool InitTestHarnessService0(uint8_t Priority)
   ES_Event_t ThisEvent;
 
   MyPriority = Priority;
+  // key strokes are published, so ask for them
+  ES_Subscribe(MyPriority, ES_NEW_KEY);
 
   // When doing testing, it is useful to announce just which program
   // is running.
@@ -271,6 +276,28 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
           DB_printf("Posted SHOOT_ACTION to ServoFSM\r\n");
           break;
           
+        case 'u':  // Print CPU utilisation over the last second
+        {
+          uint8_t idlePercent = _HW_GetIdlePercent();
+          DB_printf("CPU idle %d%%, busy %d%%\r\n", idlePercent,
+                    100 - idlePercent);
+
+          // cost of each event checker, in core timer counts (50ns each)
+          ES_CheckerStats_t checkerStats;
+          const char *checkerName;
+          uint8_t i;
+          for (i = 0; i < ES_GetNumCheckers(); i++)
+          {
+            checkerName = ES_GetCheckerStats(i, &checkerStats);
+            DB_printf("%s: calls %u, avg %u, max %u\r\n", checkerName,
+                      checkerStats.NumCalls,
+                      (checkerStats.NumCalls != 0) ?
+                      checkerStats.TotalCycles / checkerStats.NumCalls : 0,
+                      checkerStats.MaxCycles);
+          }
+        }
+        break;
+
         case 'h':  // Help - display key mappings
           DB_printf("\r\n=== Servo Control Keys ===\r\n");
           DB_printf("w - Sweep servo action\r\n");
@@ -279,6 +306,7 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
           DB_printf("S - Scoop servo retract\r\n");
           DB_printf("r - Release servo action\r\n");
           DB_printf("f - Shoot servo action (fire)\r\n");
+          DB_printf("u - Print CPU utilisation & event checker costs\r\n");
           DB_printf("h - Display this help\r\n");
           DB_printf("========================\r\n\n");
           break;
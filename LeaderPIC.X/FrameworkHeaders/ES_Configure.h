@@ -9,6 +9,30 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 18:20 Team     added ES_BEACON_BEARING
+ 10/17/26 18:00 Team     event pool off (0 blocks) until an event uses it
+ 10/17/26 17:45 Team     StackMonitorService moved to Service 0, the lowest
+                         priority; the other services move up one
+ 10/17/26 16:30 Team     ES_STACK_MONITOR off by default
+ 10/17/26 16:10 Team     ES_ISR_PROFILE off by default, opt in to measure
+ 10/17/26 15:30 Team     POOL_EVENT_LIST excludes COALESCE_LIST
+ 10/17/26 15:05 Team     added BH_SHORT_TIMER and the short timer ISR
+                         profile slots
+ 10/17/26 14:40 Team     added ES_MOVE_SETTLED
+ 10/17/26 14:15 Team     added ES_STACK_MONITOR and StackMonitorService
+ 10/17/26 13:50 Team     added ES_ISR_PROFILE and the ISR profile table
+ 10/17/26 13:25 Team     added ES_MOTOR_STALL and ES_WHEEL_SLIP
+ 10/17/26 13:00 Team     added bottom half numbers
+ 10/17/26 12:35 Team     EVENT_CHECK_LIST became EVENT_CHECK_TABLE with a
+                         period & priority for each checker
+ 10/17/26 11:45 Team     added ES_USE_EDF
+ 10/17/26 11:20 Team     added event payload pool settings
+ 10/17/26 10:55 Team     added COALESCE_LIST
+ 10/17/26 10:30 Team     added ES_BATCH_SIZE
+ 10/17/26 10:05 Team     added ES_NUM_EVENT_TYPES to size the subscription
+                         table. DIST_LISTn entries are now service numbers
+ 10/17/26 09:10 Team     raised MAX_NUM_SERVICES to 32 and added response
+                         function entries for timers 16-31
  12/19/16 20:19  jec     removed EVENT_CHECK_HEADER definition. This goes with
                          the V2.3 move to a single wrapper for event checking
                          headers
@@ -26,28 +50,47 @@
 
 /****************************************************************************/
 // The maximum number of services sets an upper bound on the number of
-// services that the framework will handle. Reasonable values are 8 and 16
-// corresponding to an 8-bit(uint8_t) and 16-bit(uint16_t) Ready variable size
-#define MAX_NUM_SERVICES 16
+// services that the framework will handle. The Ready variable is 32 bits
+// (uint32_t), so values up to 32 are supported. Services beyond 15 need
+// their SERV_n_ block added below following the pattern of the others.
+#define MAX_NUM_SERVICES 32
 
 /****************************************************************************/
 // This macro determines that nuber of services that are *actually* used in
 // a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
-#define NUM_SERVICES 6
+#define NUM_SERVICES 7
+
+/****************************************************************************/
+// Batch dispatch: once ES_Run selects a service it may hand that service up
+// to this many of its queued events in a row, as long as no higher priority
+// service becomes ready in between. 1 disables batching.
+#define ES_BATCH_SIZE 4
+
+/****************************************************************************/
+// Earliest-deadline-first dispatch. When 1, ES_Run hands out the event whose
+// deadline comes soonest instead of always serving the highest numbered
+// ready service. Services declare relative deadlines for the events they
+// care about with ES_SetDeadline(); other events get ES_EDF_DEFAULT_DEADLINE
+// (ms). ES_GetDeadlineMisses() reports where the schedule is infeasible.
+// Batch dispatch can not be combined with this, set ES_BATCH_SIZE to 1.
+#define ES_USE_EDF 0
+#define ES_EDF_DEFAULT_DEADLINE 100
 
 /****************************************************************************/
 // These are the definitions for Service 0, the lowest priority service.
 // Every Events and Services application must have a Service 0. Further
 // services are added in numeric sequence (1,2,3,...) with increasing
 // priorities
+// StackMonitorService is Service 0 so that its scan slices only run when
+// no other service has work; with ES_STACK_MONITOR off it is idle.
 // the header file with the public function prototypes
-#define SERV_0_HEADER "TestHarnessService0.h"
+#define SERV_0_HEADER "StackMonitorService.h"
 // the name of the Init function
-#define SERV_0_INIT InitTestHarnessService0
+#define SERV_0_INIT InitStackMonitorService
 // the name of the run function
-#define SERV_0_RUN RunTestHarnessService0
+#define SERV_0_RUN RunStackMonitorService
 // How big should this services Queue be?
-#define SERV_0_QUEUE_SIZE 5
+#define SERV_0_QUEUE_SIZE 3
 
 /****************************************************************************/
 // The following sections are used to define the parameters for each of the
@@ -57,24 +100,24 @@
 // These are the definitions for Service 1
 #if NUM_SERVICES > 1
 // the header file with the public function prototypes
-#define SERV_1_HEADER "SPILeaderFSM.h"
+#define SERV_1_HEADER "TestHarnessService0.h"
 // the name of the Init function
-#define SERV_1_INIT InitSPILeaderFSM
+#define SERV_1_INIT InitTestHarnessService0
 // the name of the run function
-#define SERV_1_RUN RunSPILeaderFSM
+#define SERV_1_RUN RunTestHarnessService0
 // How big should this services Queue be?
-#define SERV_1_QUEUE_SIZE 3
+#define SERV_1_QUEUE_SIZE 5
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 2
 #if NUM_SERVICES > 2
 // the header file with the public function prototypes
-#define SERV_2_HEADER "MainLogicFSM.h"
+#define SERV_2_HEADER "SPILeaderFSM.h"
 // the name of the Init function
-#define SERV_2_INIT InitMainLogicFSM
+#define SERV_2_INIT InitSPILeaderFSM
 // the name of the run function
-#define SERV_2_RUN RunMainLogicFSM
+#define SERV_2_RUN RunSPILeaderFSM
 // How big should this services Queue be?
 #define SERV_2_QUEUE_SIZE 3
 #endif
@@ -83,11 +126,11 @@
 // These are the definitions for Service 3
 #if NUM_SERVICES > 3
 // the header file with the public function prototypes
-#define SERV_3_HEADER "DCMotorService.h"
+#define SERV_3_HEADER "MainLogicFSM.h"
 // the name of the Init function
-#define SERV_3_INIT InitDCMotorService
+#define SERV_3_INIT InitMainLogicFSM
 // the name of the run function
-#define SERV_3_RUN RunDCMotorService
+#define SERV_3_RUN RunMainLogicFSM
 // How big should this services Queue be?
 #define SERV_3_QUEUE_SIZE 3
 #endif
@@ -96,11 +139,11 @@
 // These are the definitions for Service 4
 #if NUM_SERVICES > 4
 // the header file with the public function prototypes
-#define SERV_4_HEADER "BeaconDetectFSM.h"
+#define SERV_4_HEADER "DCMotorService.h"
 // the name of the Init function
-#define SERV_4_INIT InitBeaconDetectFSM
+#define SERV_4_INIT InitDCMotorService
 // the name of the run function
-#define SERV_4_RUN RunBeaconDetectFSM
+#define SERV_4_RUN RunDCMotorService
 // How big should this services Queue be?
 #define SERV_4_QUEUE_SIZE 3
 #endif
@@ -109,11 +152,11 @@
 // These are the definitions for Service 5
 #if NUM_SERVICES > 5
 // the header file with the public function prototypes
-#define SERV_5_HEADER "NavigationFSM.h"
+#define SERV_5_HEADER "BeaconDetectFSM.h"
 // the name of the Init function
-#define SERV_5_INIT InitNavigationFSM
+#define SERV_5_INIT InitBeaconDetectFSM
 // the name of the run function
-#define SERV_5_RUN RunNavigationFSM
+#define SERV_5_RUN RunBeaconDetectFSM
 // How big should this services Queue be?
 #define SERV_5_QUEUE_SIZE 3
 #endif
@@ -122,11 +165,11 @@
 // These are the definitions for Service 6
 #if NUM_SERVICES > 6
 // the header file with the public function prototypes
-#define SERV_6_HEADER "EncoderTestService.h"
+#define SERV_6_HEADER "NavigationFSM.h"
 // the name of the Init function
-#define SERV_6_INIT InitEncoderTestService
+#define SERV_6_INIT InitNavigationFSM
 // the name of the run function
-#define SERV_6_RUN RunEncoderTestService
+#define SERV_6_RUN RunNavigationFSM
 // How big should this services Queue be?
 #define SERV_6_QUEUE_SIZE 3
 #endif
@@ -265,6 +308,7 @@ typedef enum
   ES_NEW_SIGNAL_EDGE,       /* signals a new signal edge from phototransistor */
   ES_COMMAND_RETRIEVED,     /* signals a new command byte from SPI */
   ES_BEACON_DETECTED,       /* signals a beacon detection */
+  ES_BEACON_BEARING,        /* a sweep passed a beacon's beam, param = beacon id */
   ES_TAPE_DETECTED,          /* signals a tape detection */
   ES_NEW_COMMAND,            /* New command received from command generator */
   ES_START_LINE_FOLLOW,      /* Command to start line following */
@@ -273,43 +317,125 @@ typedef enum
   ES_INTERSECTION_DETECTED,  /* T-intersection detected */
   ES_TAPE_FOUND,             /* Tape found during search */
   ES_CALIB_DONE,             /* Calibration rotation complete */
-  ES_BEHAVIOR_COMPLETE       /* posted to MainLogicFSM when any atomic behavior finishes */
+  ES_BEHAVIOR_COMPLETE,      /* posted to MainLogicFSM when any atomic behavior finishes */
+  ES_MOTOR_STALL,            /* wheel(s) stalled, param = MOTOR_FAULT_STALL_x bits */
+  ES_WHEEL_SLIP,             /* wheels diverged on a straight move, MOTOR_FAULT_SLIP_x */
+  ES_MOVE_SETTLED,           /* DCMotorService position move has settled on target */
+  ES_NUM_EVENT_TYPES         /* must stay last, sizes the subscription table */
 }ES_EventType_t;
 
+/****************************************************************************/
+// Event coalescing. Event types listed here do not take a new queue slot
+// when an event that matches is still waiting in the service's queue.
+// ES_COALESCE_LATEST overwrites a pending event of the same type (use for
+// producers where only the latest value matters), ES_COALESCE_DUPLICATES
+// only drops an exact copy (same type and param) of the newest pending
+// event. Do not coalesce events that trigger an action each time.
+// Entries are designated initializers: [EventType] = mode, comma separated.
+// Comment out the define if no event types are coalesced.
+#define COALESCE_LIST \
+  [ES_MOTOR_ACTION_CHANGE] = ES_COALESCE_LATEST, \
+  [ES_NEW_SIGNAL_EDGE] = ES_COALESCE_LATEST
+
+/****************************************************************************/
+// Event payload pool. Events that need more than the 16-bit EventParam can
+// carry a handle to a fixed-size block from ES_EventPool instead. Set the
+// number of blocks (0 to 32, 0 disables the pool) and the block size in
+// bytes. List the event types that carry a handle in POOL_EVENT_LIST as
+// [EventType] = true; the framework releases their block after the run
+// function. Pool events cannot be coalesced, so POOL_EVENT_LIST and
+// COALESCE_LIST cannot both be defined (ES_EventPool.c stops the build).
+// No event uses the pool yet, so it is off and costs no RAM.
+#define ES_POOL_NUM_BLOCKS 0
+#define ES_POOL_BLOCK_SIZE 16
+//#define POOL_EVENT_LIST [ES_SOME_EVENT] = true
+
 /****************************************************************************/
 // These are the definitions for the Distribution lists. Each definition
-// should be a comma separated list of post functions to indicate which
-// services are on that distribution list.
+// should be a comma separated list of service numbers to indicate which
+// services start out on that distribution list. Membership can be changed
+// at run time with ES_AddToDistList/ES_RemoveFromDistList.
 #define NUM_DIST_LISTS 0
 #if NUM_DIST_LISTS > 0
-#define DIST_LIST0 PostTestHarnessService0, PostTestHarnessService0
+#define DIST_LIST0 0
 #endif
 #if NUM_DIST_LISTS > 1
-#define DIST_LIST1 PostTestHarnessService1, PostTestHarnessService1
+#define DIST_LIST1 0
 #endif
 #if NUM_DIST_LISTS > 2
-#define DIST_LIST2 PostTemplateFSM
+#define DIST_LIST2 0
 #endif
 #if NUM_DIST_LISTS > 3
-#define DIST_LIST3 PostTemplateFSM
+#define DIST_LIST3 0
 #endif
 #if NUM_DIST_LISTS > 4
-#define DIST_LIST4 PostTemplateFSM
+#define DIST_LIST4 0
 #endif
 #if NUM_DIST_LISTS > 5
-#define DIST_LIST5 PostTemplateFSM
+#define DIST_LIST5 0
 #endif
 #if NUM_DIST_LISTS > 6
-#define DIST_LIST6 PostTemplateFSM
+#define DIST_LIST6 0
 #endif
 #if NUM_DIST_LISTS > 7
-#define DIST_LIST7 PostTemplateFSM
+#define DIST_LIST7 0
 #endif
 
 /****************************************************************************/
-// This is the list of event checking functions
-#define EVENT_CHECK_LIST Check4Keystroke
-// , Check4TapeDetected, Check4BeaconDetected
+// Bottom half numbers (0-31) for deferred ISR work. An ISR raises its bottom
+// half with _HW_RaiseBottomHalf and the handler its service registered with
+// _HW_RegisterBottomHalf runs at task level before the next dispatch.
+// Higher numbers run first.
+#define BH_SHORT_TIMER    2   // short timer channel expired, ES_ShortTimer
+#define BH_BEACON_EDGE    1   // IC1 edge captured, BeaconDetectFSM
+#define BH_MOTOR_CONTROL  0   // control loop updated duties, DCMotorService
+
+/****************************************************************************/
+// ISR profiling. With ES_ISR_PROFILE defined, ISRs bracketed with
+// ES_ISR_ENTER(n)/ES_ISR_EXIT(n) collect execution time and entry jitter
+// histograms (TestHarnessService0 'I' key). Each table entry is
+// ES_ISR_SLOT(name, expected core timer counts between entries), 0 for ISRs
+// that are not periodic. The slot numbers index the table, keep them in
+// order. Off by default: every bracketed ISR pays for the bookkeeping with
+// interrupts held off, so define ES_ISR_PROFILE only while measuring.
+// #define ES_ISR_PROFILE
+#define ISR_PROF_IC1      0
+#define ISR_PROF_IC2      1
+#define ISR_PROF_IC3      2
+#define ISR_PROF_TIMER3   3
+#define ISR_PROF_CONTROL  4
+#define ISR_PROF_SYSTICK  5
+#define ISR_PROF_SHORT_A  6
+#define ISR_PROF_SHORT_B  7
+#define ISR_PROFILE_TABLE \
+  ES_ISR_SLOT("IC1 beacon (IPL7)", 0), \
+  ES_ISR_SLOT("IC2 right enc (IPL7)", 0), \
+  ES_ISR_SLOT("IC3 left enc (IPL7)", 0), \
+  ES_ISR_SLOT("T3 rollover (IPL6)", 16777216UL), \
+  ES_ISR_SLOT("T4 control (IPL5)", 40000UL), \
+  ES_ISR_SLOT("SysTick (IPL3)", 20000UL), \
+  ES_ISR_SLOT("T1 short timer A (IPL4)", 0), \
+  ES_ISR_SLOT("T5 short timer B (IPL4)", 0)
+
+/****************************************************************************/
+// Stack monitoring. With ES_STACK_MONITOR defined the startup code paints
+// the stack, StackMonitorService reports the high-water mark and every
+// ES_ISR_ENTER checks the stack pointer, with or without ES_ISR_PROFILE.
+// Reaching within ES_STACK_GUARD_BYTES of the heap/.bss drives the safe
+// state and halts, before anything is overwritten.
+// Off by default; main() registers the safe state handler when it is on.
+// #define ES_STACK_MONITOR
+#define ES_STACK_GUARD_BYTES 512
+
+/****************************************************************************/
+// This is the table of event checking functions. Each entry is
+// ES_CHECKER(function, minimum period in ms, priority). A period of 0 runs
+// the checker on every pass through ES_Run; higher priorities are checked
+// first. Keystrokes are checked every pass since the UART RX FIFO is only
+// a few characters deep.
+#define EVENT_CHECK_TABLE \
+  ES_CHECKER(Check4Keystroke, 0, 1)
+// , ES_CHECKER(Check4TapeDetected, 2, 2)
 
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
@@ -333,8 +459,24 @@ typedef enum
 #define TIMER11_RESP_FUNC PostMainLogicFSM
 #define TIMER12_RESP_FUNC PostMainLogicFSM
 #define TIMER13_RESP_FUNC PostMainLogicFSM
-#define TIMER14_RESP_FUNC TIMER_UNUSED
+#define TIMER14_RESP_FUNC PostStackMonitorService
 #define TIMER15_RESP_FUNC PostTestHarnessService0
+#define TIMER16_RESP_FUNC TIMER_UNUSED
+#define TIMER17_RESP_FUNC TIMER_UNUSED
+#define TIMER18_RESP_FUNC TIMER_UNUSED
+#define TIMER19_RESP_FUNC TIMER_UNUSED
+#define TIMER20_RESP_FUNC TIMER_UNUSED
+#define TIMER21_RESP_FUNC TIMER_UNUSED
+#define TIMER22_RESP_FUNC TIMER_UNUSED
+#define TIMER23_RESP_FUNC TIMER_UNUSED
+#define TIMER24_RESP_FUNC TIMER_UNUSED
+#define TIMER25_RESP_FUNC TIMER_UNUSED
+#define TIMER26_RESP_FUNC TIMER_UNUSED
+#define TIMER27_RESP_FUNC TIMER_UNUSED
+#define TIMER28_RESP_FUNC TIMER_UNUSED
+#define TIMER29_RESP_FUNC TIMER_UNUSED
+#define TIMER30_RESP_FUNC TIMER_UNUSED
+#define TIMER31_RESP_FUNC TIMER_UNUSED
 
 /****************************************************************************/
 // Give the timer numbers symbolc names to make it easier to move them
@@ -357,6 +499,7 @@ typedef enum
 #define ROTATE_SAFETY_TIMER 11
 #define BEHAVIOR_TIMEOUT_TIMER 12
 #define BALL_COLLECTION_TIMER 13
+#define STACK_MONITOR_TIMER 14
 
 
 #endif /* ES_CONFIGURE_H */
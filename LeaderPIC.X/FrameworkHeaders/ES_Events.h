@@ -8,6 +8,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 11:45 Team     added PostTime for EDF scheduling, it sits in what
+                         was padding on the PIC32 so the event stays 8 bytes
  10/19/17 14:22 jec      changed include to ES_Cpnfigre to get definition of
                          ES_EventTyp_t
  08/05/13 15:19 jec      modifications to suit new portable type definitions
@@ -28,6 +30,10 @@ typedef struct ES_Event
 {
   ES_EventType_t EventType;      // what kind of event?
   uint16_t EventParam;          // parameter value for use w/ this event
+#if ES_USE_EDF
+  uint16_t PostTime;            // ES_Timer_GetTime() when posted, set by
+                                // the framework post functions
+#endif
 }ES_Event_t;
 
 #endif /* ES_Events_H */
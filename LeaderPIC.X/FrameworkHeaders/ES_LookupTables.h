@@ -17,6 +17,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 09:10 Team     BitNum2SetMask & ES_GetMSBitSet widened to 32 bits,
+                         added ES_HAS_CLZ to select the clz based version
  10/20/13 21:19 jec      got rid of BitNum2ClrMask and replaced with #define
                          replaced Byte2MSBNum with function ES_GetMSBSet
                          replaced Byte2MSBNum array with Nybble2MSBNum
@@ -24,6 +26,16 @@
  01/15/12 13:03 jec      started coding
 *****************************************************************************/
 #include "ES_Types.h"
+
+/*
+  GCC derived compilers (XC32 for the PIC32, and gcc for host builds) give us
+  __builtin_clz, which maps to the single cycle MIPS clz instruction. Other
+  compilers fall back to the nybble lookup table.
+*/
+#if defined(__GNUC__) && !defined(ES_NO_CLZ)
+#define ES_HAS_CLZ
+#endif
+
 /*
   Since we moved up to 16 timers & services, this table got too big to justify
   having a separate table for the clear and set masks, so just #define the
@@ -32,10 +44,10 @@
 #define BitNum2ClrMask ~BitNum2SetMask
 
 /*
-  this table is used to go from a bit number (0-7) to the mask used to set
-  that bit in a byte.
+  this table is used to go from a bit number (0-31) to the mask used to set
+  that bit in a word.
 */
-extern uint16_t const BitNum2SetMask[];
+extern uint32_t const BitNum2SetMask[];
 
 /*
   this table is used to go from an unsigned 4bit value to the most significant
@@ -50,14 +62,15 @@ extern uint8_t const Nybble2MSBitNum[15];
  Function
    ES_GetMSBSet
  Parameters
-   uint16_t  Val2Check The number to find the MSB in
+   uint32_t  Val2Check The number to find the MSB in
  Returns
    bit number of the MSB that is set in Val2Check, 128 if Val2Check = 0
  Description
    find the MSB that is set in Val2Check and returns that bit number
  Notes
+   constant time when ES_HAS_CLZ is defined, otherwise up to 8 table lookups
 
  Author
    J. Edward Carryer, 10/20/13, 17:03
 ****************************************************************************/
-uint8_t ES_GetMSBitSet(uint16_t Val2Check);
+uint8_t ES_GetMSBitSet(uint32_t Val2Check);
@@ -9,6 +9,18 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 18:40 Team    ES_ISR_ENTER checks the stack with ES_STACK_MONITOR
+                        alone; the stack fault only writes a fixed message
+ 10/17/26 14:15 Team    added stack painting, high-water scan, ISR nesting
+                        depth and the stack fault dump
+ 10/17/26 13:50 Team    added ISR execution time & entry jitter profiling
+ 10/17/26 13:00 Team    added ES_AtomicExchange and the bottom half (deferred
+                        ISR work) interface
+ 10/17/26 12:35 Team    added _HW_GetCoreCount
+ 10/17/26 12:10 Team    added _HW_Idle, _HW_GetIdlePercent and ES_IDLE_WAIT
+ 10/17/26 11:20 Team    added ES_AtomicCompareAndSwap and ES_AtomicAddFetch
+ 10/17/26 09:40 Team    added ES_AtomicSetBits/ES_AtomicClrBits for lock-free
+                        updates of the Ready variable
  10/26/17 18:39 jec     moves definition of ALL_BITS to here
  10/14/15 21:50 jec     added prototype for ES_Timer_GetTime
  01/18/15 13:24 jec     clean up and adapt to use TI driver lib functions
@@ -30,6 +42,7 @@
 #include "bitdefs.h"        /* generic bit defs (BIT0HI, BIT0LO,...) */
 #include "Bin_Const.h"      /* macros to specify binary constants in C */
 #include "ES_Types.h"
+#include "ES_Configure.h"   /* for ES_ISR_PROFILE, ES_STACK_MONITOR etc */
 
 #include "terminal.h"
 
@@ -83,6 +96,159 @@ extern  uint8_t _INTCON_temp;
 #define ExitCritical()
 #endif
 
+// When defined, ES_Run executes WAIT (CPU Idle mode) once a full pass finds
+// no events, no user events and nothing left to send to the UART. Comment
+// out to spin instead, for instance when timing the loop with a scope.
+#define ES_IDLE_WAIT
+
+// Atomic bit set/clear on a 32-bit word in RAM. The RAM has no SET/CLR
+// aliases like the SFRs, so on the M4K these compile to an LL/SC retry loop.
+// An interrupt taken between the LL and the SC clears the link bit, so the
+// SC fails and the update is retried rather than overwriting the ISR's
+// change. No interrupts are disabled, so these are safe at any IPL and can
+// be used inside a critical region.
+#if defined(__GNUC__)
+#define ES_AtomicSetBits(pWord, Mask) \
+  ((void)__atomic_fetch_or((pWord), (Mask), __ATOMIC_SEQ_CST))
+#define ES_AtomicClrBits(pWord, Mask) \
+  ((void)__atomic_fetch_and((pWord), ~(Mask), __ATOMIC_SEQ_CST))
+// true if *pWord was Expected and has been replaced by Desired
+#define ES_AtomicCompareAndSwap(pWord, Expected, Desired) \
+  __sync_bool_compare_and_swap((pWord), (Expected), (Desired))
+// adds Delta (may be negative) and returns the new value
+#define ES_AtomicAddFetch(pWord, Delta) \
+  __atomic_add_fetch((pWord), (Delta), __ATOMIC_SEQ_CST)
+// stores Value and returns what was there before
+#define ES_AtomicExchange(pWord, Value) \
+  __atomic_exchange_n((pWord), (Value), __ATOMIC_SEQ_CST)
+#else
+#define ES_AtomicSetBits(pWord, Mask) \
+  do { EnterCritical(); *(pWord) |= (Mask); ExitCritical(); } while (0)
+#define ES_AtomicClrBits(pWord, Mask) \
+  do { EnterCritical(); *(pWord) &= ~(Mask); ExitCritical(); } while (0)
+static inline bool ES_AtomicCompareAndSwap(volatile uint32_t *pWord,
+    uint32_t Expected, uint32_t Desired)
+{
+  bool Swapped;
+  EnterCritical();
+  Swapped = (*pWord == Expected);
+  if (Swapped)
+  {
+    *pWord = Desired;
+  }
+  ExitCritical();
+  return Swapped;
+}
+static inline uint32_t ES_AtomicAddFetch(volatile uint32_t *pWord,
+    int32_t Delta)
+{
+  uint32_t NewValue;
+  EnterCritical();
+  NewValue = (*pWord += Delta);
+  ExitCritical();
+  return NewValue;
+}
+static inline uint32_t ES_AtomicExchange(volatile uint32_t *pWord,
+    uint32_t Value)
+{
+  uint32_t OldValue;
+  EnterCritical();
+  OldValue = *pWord;
+  *pWord = Value;
+  ExitCritical();
+  return OldValue;
+}
+#endif
+
+// Bottom halves. An ISR that has work for task level does only the time
+// critical part itself, stashes any raw data (a single word store, or a
+// single producer ring buffer) and raises its bottom half, which is one bit
+// in _HW_PendingWork. _HW_Process_Pending_Ints runs the handlers for the
+// raised bits, highest number first, in task context before every dispatch,
+// so the handler can post events without the ISR taking the queue critical
+// regions. Raising a bit that is already raised runs the handler only once,
+// so a handler must drain everything its ISR has stashed.
+// The bottom half numbers (0-31) are assigned in ES_Configure.h.
+typedef void BottomHalfFunc_t(void);
+extern volatile uint32_t _HW_PendingWork;
+#define _HW_RaiseBottomHalf(WhichBH) \
+  ES_AtomicSetBits(&_HW_PendingWork, (1UL << (WhichBH)))
+
+// ISR profiling. An ISR brackets its body with ES_ISR_ENTER(n) and
+// ES_ISR_EXIT(n), n being its slot in ISR_PROFILE_TABLE (ES_Configure.h).
+// Each slot gets log2 histograms of execution time, less any time spent
+// in ISRs that preempted it, and of entry jitter, the difference between
+// the time from one entry to the next and the slot's expected period.
+// Times are core timer counts (50ns). Bin 0 holds 0, bin k holds
+// 2^(k-1) to 2^k - 1 and the last bin everything longer. Without
+// ES_ISR_PROFILE defined in ES_Configure.h the brackets compile to nothing.
+#define ES_ISR_HIST_BINS 16
+
+// one entry in ISR_PROFILE_TABLE, use ES_ISR_SLOT() to build these
+typedef struct
+{
+  const char  *Name;      // for reporting
+  uint32_t    Period;     // expected core timer counts between entries, 0 if
+                          // the ISR is not periodic (no jitter recorded)
+}ES_ISRSlotDesc_t;
+
+#define ES_ISR_SLOT(Name, Period) { Name, Period }
+
+typedef struct
+{
+  uint32_t NumCalls;          // completed entry/exit pairs
+  uint32_t TotalExecCycles;   // preemption adjusted execution time, summed
+  uint32_t MaxExecCycles;
+  uint32_t MaxJitterCycles;
+  uint32_t ExecHist[ES_ISR_HIST_BINS];
+  uint32_t JitterHist[ES_ISR_HIST_BINS];
+}ES_ISRStats_t;
+
+#ifdef ES_STACK_MONITOR
+#define ES_STACK_CHECK() _HW_StackCheck()
+#else
+#define ES_STACK_CHECK() ((void)0)
+#endif
+
+#ifdef ES_ISR_PROFILE
+#define ES_ISR_ENTER(WhichISR) \
+  do { ES_STACK_CHECK(); _HW_ISRProfileEnter(WhichISR); } while (0)
+#define ES_ISR_EXIT(WhichISR)  _HW_ISRProfileExit(WhichISR)
+void _HW_ISRProfileEnter(uint8_t WhichISR);
+void _HW_ISRProfileExit(uint8_t WhichISR);
+uint8_t _HW_GetNumISRSlots(void);
+const char *_HW_GetISRStats(uint8_t WhichISR, ES_ISRStats_t *pStats);
+void _HW_ResetISRStats(void);
+uint8_t _HW_GetMaxISRDepth(void);
+#else
+#define ES_ISR_ENTER(WhichISR) ES_STACK_CHECK()
+#define ES_ISR_EXIT(WhichISR)  ((void)0)
+#endif
+
+// Stack monitoring. With ES_STACK_MONITOR defined in ES_Configure.h the
+// startup code (_on_reset) paints the free stack, from _splim (top of the
+// heap) up to just below the stack pointer, with ES_STACK_PAINT. The
+// high-water mark is found by scanning up from _splim for the first word
+// that is no longer paint; _HW_StackScanStep does this a slice at a time so
+// no single call holds up the framework. Every ES_ISR_ENTER checks the
+// stack pointer, which is where the stack is deepest, and calls
+// _HW_StackFault if it is within ES_STACK_GUARD_BYTES of _splim, whether
+// or not ES_ISR_PROFILE is defined. _HW_StackFault puts the hardware into
+// a safe state through the registered handler, writes a fixed message
+// straight to the UART and never returns.
+#define ES_STACK_PAINT 0xA5A5A5A5UL
+
+typedef void SafeStateFunc_t(void);
+
+#ifdef ES_STACK_MONITOR
+bool _HW_StackScanStep(uint32_t MaxWords);
+uint32_t _HW_GetStackSize(void);
+uint32_t _HW_GetStackHighWater(void);
+void _HW_SetSafeStateHandler(SafeStateFunc_t *Handler);
+void _HW_StackCheck(void);
+void __attribute__((noreturn)) _HW_StackFault(const char *Why);
+#endif
+
 /* Rate constants for programming the SysTick Period to generate tick interrupts.
    These assume that we are using the M4K core timer running at 20MHz. Even
    thought the processor clock is 40MHz the core timer increments every other 
@@ -116,6 +282,11 @@ bool kbhit(void);                // is a charcter ready on the EUSART?
 void _HW_PIC32Init(void);
 void _HW_Timer_Init(const TimerRate_t Rate);
 bool _HW_Process_Pending_Ints(void);
+bool _HW_Idle(void);
+bool _HW_RegisterBottomHalf(uint8_t WhichBH, BottomHalfFunc_t *Handler);
+// free running core timer count (SYSCLK/2) for measuring execution time
+#define _HW_GetCoreCount() _CP0_GET_COUNT()
+uint8_t _HW_GetIdlePercent(void);
 uint16_t _HW_GetTickCount(void);
 void _HW_ConsoleInit(void);
 void _HW_SysTickIntHandler(void);
@@ -9,6 +9,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 10:05 Team     added run-time list membership functions
  08/05/13 15:19 jec      modifications to suit new portable type definitions
  01/15/12 11:57 jec      modified includes to match Events & Services
  10/16/11 12:28 jec      started coding
@@ -32,4 +33,8 @@ bool  ES_PostList05(ES_Event_t);
 bool  ES_PostList06(ES_Event_t);
 bool  ES_PostList07(ES_Event_t);
 
+void  ES_InitDistLists(void);
+bool  ES_AddToDistList(uint8_t WhichList, uint8_t WhichService);
+bool  ES_RemoveFromDistList(uint8_t WhichList, uint8_t WhichService);
+
 #endif // ES_PostList_H
@@ -9,6 +9,10 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 15:30 Team     ES_COALESCE_DUPLICATES matches the newest entry only
+ 10/17/26 11:45 Team     added ES_PeekQueue prototype
+ 10/17/26 10:55 Team     added ES_CoalesceMode_t and ES_EnQueueFIFOCoalesce
+ 10/17/26 10:05 Team     added ES_EnQueueFIFOMulti prototype
  08/05/13 15:19 jec      modifications to suit new portable type definitions
  01/15/12 09:36 jec      converted to use new types from ES_Types.h
  10/17/11 07:49 jec      new header to match the rest of the framework
@@ -20,14 +24,27 @@
 #include "ES_Types.h"
 #include "ES_Events.h"
 
+// How an enqueue treats an event of the same kind that is still pending
+typedef enum
+{
+  ES_COALESCE_NONE = 0,   // always take a new slot (normal FIFO post)
+  ES_COALESCE_LATEST,     // same EventType pending: overwrite it (mailbox)
+  ES_COALESCE_DUPLICATES  // identical event newest in queue: drop the copy
+}ES_CoalesceMode_t;
+
 /* prototypes for public functions */
 
 uint8_t ES_InitQueue(ES_Event_t *pBlock, uint8_t BlockSize);
 bool ES_EnQueueFIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
+bool ES_EnQueueFIFOCoalesce(ES_Event_t *pBlock, ES_Event_t Event2Add,
+    ES_CoalesceMode_t Mode);
+bool ES_EnQueueFIFOMulti(ES_Event_t *const *pBlocks, uint8_t NumBlocks,
+    ES_Event_t Event2Add, ES_CoalesceMode_t Mode);
 bool ES_EnQueueLIFO(ES_Event_t *pBlock, ES_Event_t Event2Add);
 uint8_t ES_DeQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
 //void EF_FlushQueue( unsigned char * pBlock );
 bool ES_IsQueueEmpty(ES_Event_t *pBlock);
+bool ES_PeekQueue(ES_Event_t *pBlock, ES_Event_t *pReturnEvent);
 
 #endif /*ES_Queue_H */
 
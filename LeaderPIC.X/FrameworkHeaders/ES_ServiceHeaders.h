@@ -7,6 +7,7 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 09:10 Team     added entries for services 16-31
  01/15/12 10:35 jec      started coding
 *****************************************************************************/
 
@@ -73,3 +74,67 @@
 #if NUM_SERVICES > 15
 #include SERV_15_HEADER
 #endif
+
+#if NUM_SERVICES > 16
+#include SERV_16_HEADER
+#endif
+
+#if NUM_SERVICES > 17
+#include SERV_17_HEADER
+#endif
+
+#if NUM_SERVICES > 18
+#include SERV_18_HEADER
+#endif
+
+#if NUM_SERVICES > 19
+#include SERV_19_HEADER
+#endif
+
+#if NUM_SERVICES > 20
+#include SERV_20_HEADER
+#endif
+
+#if NUM_SERVICES > 21
+#include SERV_21_HEADER
+#endif
+
+#if NUM_SERVICES > 22
+#include SERV_22_HEADER
+#endif
+
+#if NUM_SERVICES > 23
+#include SERV_23_HEADER
+#endif
+
+#if NUM_SERVICES > 24
+#include SERV_24_HEADER
+#endif
+
+#if NUM_SERVICES > 25
+#include SERV_25_HEADER
+#endif
+
+#if NUM_SERVICES > 26
+#include SERV_26_HEADER
+#endif
+
+#if NUM_SERVICES > 27
+#include SERV_27_HEADER
+#endif
+
+#if NUM_SERVICES > 28
+#include SERV_28_HEADER
+#endif
+
+#if NUM_SERVICES > 29
+#include SERV_29_HEADER
+#endif
+
+#if NUM_SERVICES > 30
+#include SERV_30_HEADER
+#endif
+
+#if NUM_SERVICES > 31
+#include SERV_31_HEADER
+#endif
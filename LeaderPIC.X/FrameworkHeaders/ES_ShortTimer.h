@@ -0,0 +1,37 @@
+/****************************************************************************
+ Module
+     ES_ShortTimer.h
+
+ Description
+     Header file for the short (microsecond) one-shot timers
+
+ Notes
+     Each channel posts ES_SHORT_TIMEOUT, with the channel number as the
+     EventParam, to the service it was given in ES_ShortTimerInit.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26 15:05 Team    PIC32 port, channels are Timer1 and Timer5, added
+                        ES_ShortTimerStop
+ 10/11/15 10:30 jec     first pass
+****************************************************************************/
+
+#ifndef ES_ShortTimer_H
+#define ES_ShortTimer_H
+
+#include "ES_Types.h"
+
+// channel numbers, also the EventParam of their ES_SHORT_TIMEOUT
+#define TIMER_A                  0u   // Timer1
+#define TIMER_B                  1u   // Timer5
+#define SHORT_TIMER_NUM_CHANNELS 2u
+
+// service priority for a channel that does not post anywhere
+#define SHORT_TIMER_UNUSED       ((uint8_t)~0)
+
+void ES_ShortTimerInit(uint8_t TimeAPrio, uint8_t TimeBPrio);
+void ES_ShortTimerStart(uint8_t Which, uint16_t TimeoutValue);
+void ES_ShortTimerStop(uint8_t Which);
+
+#endif /* ES_ShortTimer_H */
@@ -8,6 +8,9 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 12:35 Team    checkers are rate scheduled from EVENT_CHECK_TABLE,
+                        run in priority order only when due, with per
+                        checker call count & cost accounting
                 jec     out all user modifications into ES_Configure
  10/16/11 12:32 jec      started coding
 *****************************************************************************/
@@ -16,20 +19,75 @@
 #include "ES_Events.h"
 #include "ES_General.h"
 #include "ES_CheckEvents.h"
+#include "ES_Port.h"
+#include "ES_Timers.h"
 
 // Include the header files for the module(s) with your event checkers.
 // This gets you the prototypes for the event checking functions.
 
 #include "EventCheckWrapper.h"
 
-// Fill in this array with the names of your event checking functions
+// EVENT_CHECK_TABLE in ES_Configure.h fills in this array with the checking
+// functions, their minimum periods and their priorities
 
-static CheckFunc *const ES_EventList[] = {
-  EVENT_CHECK_LIST
+static const ES_CheckerDesc_t ES_EventList[] = {
+  EVENT_CHECK_TABLE
 };
 
+#define NUM_CHECKERS ARRAY_SIZE(ES_EventList)
+
+// the order to run the checkers in, highest priority first
+static uint8_t RunOrder[NUM_CHECKERS];
+// ES_Timer_GetTime() when each checker last ran
+static uint16_t LastRunTime[NUM_CHECKERS];
+// cost accounting
+static ES_CheckerStats_t Stats[NUM_CHECKERS];
+
 // Implementation for public functions
 
+/****************************************************************************
+ Function
+   ES_InitUserEvents
+ Parameters
+   None
+ Returns
+   None
+ Description
+   sorts the checkers into priority order and clears the accounting
+ Notes
+   called from ES_Initialize. Checkers with equal priority keep their
+   order from EVENT_CHECK_TABLE.
+ Author
+   Team, 10/17/26
+****************************************************************************/
+void ES_InitUserEvents(void)
+{
+  uint8_t i;
+  uint8_t j;
+  uint8_t Temp;
+
+  for (i = 0; i < NUM_CHECKERS; i++)
+  {
+    RunOrder[i]             = i;
+    LastRunTime[i]          = ES_Timer_GetTime();
+    Stats[i].NumCalls       = 0;
+    Stats[i].TotalCycles    = 0;
+    Stats[i].MaxCycles      = 0;
+  }
+  // insertion sort, the list is only a handful of entries long
+  for (i = 1; i < NUM_CHECKERS; i++)
+  {
+    Temp = RunOrder[i];
+    for (j = i; (j > 0) &&
+        (ES_EventList[RunOrder[j - 1]].Priority < ES_EventList[Temp].Priority);
+        j--)
+    {
+      RunOrder[j] = RunOrder[j - 1];
+    }
+    RunOrder[j] = Temp;
+  }
+}
+
 /****************************************************************************
  Function
    ES_CheckUserEvents
@@ -38,31 +96,89 @@ static CheckFunc *const ES_EventList[] = {
  Returns
    bool: true if any of the user event checkers returned true, false otherwise
  Description
-   loop through the EF_EventList array executing the event checking functions
+   runs, in priority order, the event checking functions that are due
  Notes
-
+   a checker is due when at least its Period (ms) has passed since it last
+   ran; a Period of 0 runs it on every pass. As before, the scan stops at
+   the first checker that finds an event so that it gets processed first.
  Author
    J. Edward Carryer, 10/25/11, 08:55
 ****************************************************************************/
 bool ES_CheckUserEvents(void)
 {
-  uint8_t i;
-  // loop through the array executing the event checking functions
-  for (i = 0; i < ARRAY_SIZE(ES_EventList); i++)
+  uint8_t   i;
+  uint8_t   Which;
+  uint16_t  Now = ES_Timer_GetTime();
+  uint32_t  StartCount;
+  uint32_t  Cycles;
+  bool      FoundEvent = false;
+
+  for (i = 0; (i < NUM_CHECKERS) && !FoundEvent; i++)
   {
-    if (ES_EventList[i]() == true)
+    Which = RunOrder[i];
+    if ((uint16_t)(Now - LastRunTime[Which]) < ES_EventList[Which].Period)
     {
-      break; // found a new event, so process it first
+      continue; // not due yet
+    }
+    LastRunTime[Which] = Now;
+
+    StartCount  = _HW_GetCoreCount();
+    FoundEvent  = ES_EventList[Which].CheckFunc();
+    Cycles      = _HW_GetCoreCount() - StartCount;
+
+    Stats[Which].NumCalls++;
+    Stats[Which].TotalCycles += Cycles;
+    if (Cycles > Stats[Which].MaxCycles)
+    {
+      Stats[Which].MaxCycles = Cycles;
     }
   }
-  if (i == ARRAY_SIZE(ES_EventList))   // if no new events
-  {
-    return false;
-  }
-  else
+  return FoundEvent;
+}
+
+/****************************************************************************
+ Function
+   ES_GetNumCheckers
+ Parameters
+   None
+ Returns
+   uint8_t: the number of entries in EVENT_CHECK_TABLE
+ Description
+   for walking the checker statistics
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+uint8_t ES_GetNumCheckers(void)
+{
+  return NUM_CHECKERS;
+}
+
+/****************************************************************************
+ Function
+   ES_GetCheckerStats
+ Parameters
+   uint8_t WhichChecker : index into EVENT_CHECK_TABLE
+   ES_CheckerStats_t *pStats : where to copy the statistics
+ Returns
+   const char *: the checker's name, NULL if WhichChecker is out of range
+ Description
+   reports how often a checker has run and what it has cost in core timer
+   counts (2 SYSCLK cycles each)
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+const char *ES_GetCheckerStats(uint8_t WhichChecker, ES_CheckerStats_t *pStats)
+{
+  if (WhichChecker >= NUM_CHECKERS)
   {
-    return true;
+    return (const char *)0;
   }
+  *pStats = Stats[WhichChecker];
+  return ES_EventList[WhichChecker].Name;
 }
 
 /*------------------------------- Footnotes -------------------------------*/
@@ -18,6 +18,10 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 09:10 Team     widened BitNum2SetMask to 32 entries and made
+                         ES_GetMSBitSet use the MIPS clz instruction (via
+                         __builtin_clz) when the compiler provides it. The
+                         nybble table walk is kept as the portable fallback.
  10/20/13 17:03 jec      converted Byte2MSBitNum array to a Nybble sized array
                          (15 entries) and made function GetMSBitSet() to figure
                          out the MSB set. This was done to facilitate moving to
@@ -56,12 +60,14 @@ uint16_t const BitNum2ClrMask[] = {
 */
 
 /*
-  this table is used to go from a bit number (0-15) to the mask used to set
-  that bit in a byte.
+  this table is used to go from a bit number (0-31) to the mask used to set
+  that bit in a word.
 */
-uint16_t const BitNum2SetMask[] = {
+uint32_t const BitNum2SetMask[] = {
   BIT0HI, BIT1HI, BIT2HI, BIT3HI, BIT4HI, BIT5HI, BIT6HI, BIT7HI, BIT8HI, BIT9HI,
-  BIT10HI, BIT11HI, BIT12HI, BIT13HI, BIT14HI, BIT15HI
+  BIT10HI, BIT11HI, BIT12HI, BIT13HI, BIT14HI, BIT15HI, BIT16HI, BIT17HI,
+  BIT18HI, BIT19HI, BIT20HI, BIT21HI, BIT22HI, BIT23HI, BIT24HI, BIT25HI,
+  BIT26HI, BIT27HI, BIT28HI, BIT29HI, BIT30HI, BIT31HI
 };
 
 /*
@@ -76,8 +82,18 @@ uint8_t const Nybble2MSBitNum[15] = {
 };
 
 /*------------------------------ Module Code ------------------------------*/
-uint8_t ES_GetMSBitSet(uint16_t Val2Check)
+uint8_t ES_GetMSBitSet(uint32_t Val2Check)
 {
+#ifdef ES_HAS_CLZ
+  // clz is a single cycle on the M4K core and is undefined for 0, so keep
+  // the same error return as the table walk for that case
+  if (Val2Check == 0)
+  {
+    return 128;
+  }
+  return (uint8_t)((sizeof(Val2Check) * BITS_PER_BYTE - 1) -
+         __builtin_clz(Val2Check));
+#else
   int8_t  LoopCntr;
   uint8_t Nybble2Test;
   uint8_t ReturnVal = 128; // this is the error return value
@@ -99,6 +115,7 @@ uint8_t ES_GetMSBitSet(uint16_t Val2Check)
     }
   }
   return ReturnVal;
+#endif
 }
 
 /***************************************************************************
@@ -109,7 +126,7 @@ uint8_t ES_GetMSBitSet(uint16_t Val2Check)
 
 void main(void)
 {
-  uint16_t  Counter = 0;
+  uint32_t  Counter = 0;
   uint8_t   MSBit;
 
   puts( "Testing the MSB Look-up function\n\r");
@@ -118,11 +135,16 @@ void main(void)
   MSBit = ES_GetMSBitSet(Counter);
     printf("the MSB set in %u is bit %d\n\r", Counter, MSBit);
 
-  for (Counter = 1; Counter != 0; Counter++)
+  for (Counter = 1; Counter != 0x10000; Counter++)
   {
     MSBit = ES_GetMSBitSet(Counter);
     printf("the MSB set in %u is bit %d\n\r", Counter, MSBit);
   }
+  for (MSBit = 16; MSBit < 32; MSBit++)
+  {
+    Counter = BitNum2SetMask[MSBit] | 1;
+    printf("the MSB set in %u is bit %d\n\r", Counter, ES_GetMSBitSet(Counter));
+  }
 }
 
 #endif
@@ -9,6 +9,9 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 10:05 Team    lists are now run-time service masks posted with the
+                        framework's all-or-nothing ES_PostToServices. The
+                        DIST_LISTn entries give the initial members
  10/26/17 18:20 jec     moved prototype of PostToList into the conditional to
                         eliminate warning when not using distribution lists
  08/05/13 15:04 jec      added #includes for ES_Port & ES_Types and converted
@@ -23,56 +26,62 @@
 #include "../FrameworkHeaders/ES_Configure.h"
 #include "../FrameworkHeaders/ES_General.h"
 #include "../FrameworkHeaders/ES_PostList.h"
+#include "../FrameworkHeaders/ES_Framework.h"
+#include "../FrameworkHeaders/ES_LookupTables.h"
 #include "../FrameworkHeaders/ES_ServiceHeaders.h"
 
 /*---------------------------- Module Functions ---------------------------*/
 
 /*---------------------------- Module Variables ---------------------------*/
-// Fill in these arrays with the lists of posting funcitons for the state
-// machines that will have common events delivered to them.
+// Fill in the DIST_LISTn entries in ES_Configure.h with the numbers of the
+// services that start out on each list. Services can join or leave a list
+// at run time with ES_AddToDistList/ES_RemoveFromDistList.
 
 #if NUM_DIST_LISTS > 0
-static bool PostToList(PostFunc_t *const *FuncList, uint8_t ListSize, ES_Event_t NewEvent);
-static PostFunc_t *const DistList00[] = {
+static void InitList(uint8_t WhichList, uint8_t const *Members, uint8_t NumMembers);
+static const uint8_t DistList00[] = {
   DIST_LIST0
 };
 // the endif for NUM_DIST_LISTS > 0 is at the end of the file
 #if NUM_DIST_LISTS > 1
-static PostFunc_t *const DistList01[] = {
+static const uint8_t DistList01[] = {
   DIST_LIST1
 };
 #endif
 #if NUM_DIST_LISTS > 2
-static PostFunc_t *const DistList02[] = {
+static const uint8_t DistList02[] = {
   DIST_LIST2
 };
 #endif
 #if NUM_DIST_LISTS > 3
-static PostFunc_t *const DistList03[] = {
+static const uint8_t DistList03[] = {
   DIST_LIST3
 };
 #endif
 #if NUM_DIST_LISTS > 4
-static PostFunc_t *const DistList04[] = {
+static const uint8_t DistList04[] = {
   DIST_LIST4
 };
 #endif
 #if NUM_DIST_LISTS > 5
-static PostFunc_t *const DistList05[] = {
+static const uint8_t DistList05[] = {
   DIST_LIST5
 };
 #endif
 #if NUM_DIST_LISTS > 6
-static PostFunc_t *const DistList06[] = {
+static const uint8_t DistList06[] = {
   DIST_LIST6
 };
 #endif
 #if NUM_DIST_LISTS > 7
-static PostFunc_t *const DistList07[] = {
+static const uint8_t DistList07[] = {
   DIST_LIST7
 };
 #endif
 
+// the current members of each list, one bit per service
+static volatile uint32_t DistListMasks[NUM_DIST_LISTS];
+
 /*------------------------------ Module Code ------------------------------*/
 
 // Each of these list-specific functions is a wrapper that calls the generic
@@ -85,9 +94,10 @@ static PostFunc_t *const DistList07[] = {
    ES_Event NewEvent : the new event to be passed to each of the state machine
    posting functions in list xx
  Returns
-   bool: true if all the post functions succeeded, false if any failed
+   bool: true if the event was posted to every member, false if it was
+   posted to none of them
  Description
-   Posts NewEvent to all of the state machines listed in the list
+   Posts NewEvent to all of the services currently on list xx
  Notes
 
  Author
@@ -95,13 +105,13 @@ static PostFunc_t *const DistList07[] = {
 ****************************************************************************/
 bool ES_PostList00(ES_Event_t NewEvent)
 {
-  return PostToList(DistList00, ARRAY_SIZE(DistList00), NewEvent);
+  return ES_PostToServices(DistListMasks[0], NewEvent);
 }
 
 #if NUM_DIST_LISTS > 1
 bool ES_PostList01(ES_Event_t NewEvent)
 {
-  return PostToList(DistList01, ARRAY_SIZE(DistList01), NewEvent);
+  return ES_PostToServices(DistListMasks[1], NewEvent);
 }
 
 #endif
@@ -109,7 +119,7 @@ bool ES_PostList01(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 2
 bool ES_PostList02(ES_Event_t NewEvent)
 {
-  return PostToList(DistList02, ARRAY_SIZE(DistList02), NewEvent);
+  return ES_PostToServices(DistListMasks[2], NewEvent);
 }
 
 #endif
@@ -117,7 +127,7 @@ bool ES_PostList02(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 3
 bool ES_PostList03(ES_Event_t NewEvent)
 {
-  return PostToList(DistList03, ARRAY_SIZE(DistList03), NewEvent);
+  return ES_PostToServices(DistListMasks[3], NewEvent);
 }
 
 #endif
@@ -125,7 +135,7 @@ bool ES_PostList03(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 4
 bool ES_PostList04(ES_Event_t NewEvent)
 {
-  return PostToList(DistList04, ARRAY_SIZE(DistList04), NewEvent);
+  return ES_PostToServices(DistListMasks[4], NewEvent);
 }
 
 #endif
@@ -133,7 +143,7 @@ bool ES_PostList04(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 5
 bool ES_PostList05(ES_Event_t NewEvent)
 {
-  return PostToList(DistList05, ARRAY_SIZE(DistList05), NewEvent);
+  return ES_PostToServices(DistListMasks[5], NewEvent);
 }
 
 #endif
@@ -141,7 +151,7 @@ bool ES_PostList05(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 6
 bool ES_PostList06(ES_Event_t NewEvent)
 {
-  return PostToList(DistList06, ARRAY_SIZE(DistList06), NewEvent);
+  return ES_PostToServices(DistListMasks[6], NewEvent);
 }
 
 #endif
@@ -149,47 +159,125 @@ bool ES_PostList06(ES_Event_t NewEvent)
 #if NUM_DIST_LISTS > 7
 bool ES_PostList07(ES_Event_t NewEvent)
 {
-  return PostToList(DistList07, ARRAY_SIZE(DistList07), NewEvent);
+  return ES_PostToServices(DistListMasks[7], NewEvent);
 }
 
 #endif
 
-// Implementations for private functions
 /****************************************************************************
  Function
-   PostToList
+   ES_InitDistLists
+ Parameters
+   None
+ Returns
+   None
+ Description
+   loads each list with the members given by DIST_LISTn in ES_Configure.h
+ Notes
+   called from ES_Initialize before any of the service init functions
+ Author
+   Team, 10/17/26
+****************************************************************************/
+void ES_InitDistLists(void)
+{
+  InitList(0, DistList00, ARRAY_SIZE(DistList00));
+#if NUM_DIST_LISTS > 1
+  InitList(1, DistList01, ARRAY_SIZE(DistList01));
+#endif
+#if NUM_DIST_LISTS > 2
+  InitList(2, DistList02, ARRAY_SIZE(DistList02));
+#endif
+#if NUM_DIST_LISTS > 3
+  InitList(3, DistList03, ARRAY_SIZE(DistList03));
+#endif
+#if NUM_DIST_LISTS > 4
+  InitList(4, DistList04, ARRAY_SIZE(DistList04));
+#endif
+#if NUM_DIST_LISTS > 5
+  InitList(5, DistList05, ARRAY_SIZE(DistList05));
+#endif
+#if NUM_DIST_LISTS > 6
+  InitList(6, DistList06, ARRAY_SIZE(DistList06));
+#endif
+#if NUM_DIST_LISTS > 7
+  InitList(7, DistList07, ARRAY_SIZE(DistList07));
+#endif
+}
+
+/****************************************************************************
+ Function
+   ES_AddToDistList
  Parameters
-   PostFunc *const*List : pointer to the list of posting functions
-   unsigned char ListSize : number of elements in the list array
-   EF_Event NewEvent : the new event to be passed to each of the state machine
-   posting functions in the list
+   uint8_t WhichList : number of the distribution list
+   uint8_t WhichService : number of the service to add
  Returns
-   bool: true if all the post functions succeeded, false if any failed
+   bool: false if either number is out of range
  Description
-   Posts NewEvent to all of the state machines listed in the list
+   adds a service to a distribution list
  Notes
 
  Author
-   J. Edward Carryer, 10/24/11, 07:52
+   Team, 10/17/26
 ****************************************************************************/
-static bool PostToList(PostFunc_t *const *List, uint8_t ListSize, ES_Event_t NewEvent)
+bool ES_AddToDistList(uint8_t WhichList, uint8_t WhichService)
 {
-  uint8_t i;
-  // loop through the list executing the post functions
-  for (i = 0; i < ListSize; i++)
+  if ((WhichList >= NUM_DIST_LISTS) || (WhichService >= NUM_SERVICES))
   {
-    if (List[i](NewEvent) != true)
-    {
-      break; // this is a failed post
-    }
+    return false;
   }
-  if (i != ListSize)   // if no failures, i = ListSize
+  ES_AtomicSetBits(&DistListMasks[WhichList], BitNum2SetMask[WhichService]);
+  return true;
+}
+
+/****************************************************************************
+ Function
+   ES_RemoveFromDistList
+ Parameters
+   uint8_t WhichList : number of the distribution list
+   uint8_t WhichService : number of the service to remove
+ Returns
+   bool: false if either number is out of range
+ Description
+   removes a service from a distribution list
+ Notes
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+bool ES_RemoveFromDistList(uint8_t WhichList, uint8_t WhichService)
+{
+  if ((WhichList >= NUM_DIST_LISTS) || (WhichService >= NUM_SERVICES))
   {
     return false;
   }
-  else
+  ES_AtomicClrBits(&DistListMasks[WhichList], BitNum2SetMask[WhichService]);
+  return true;
+}
+
+// Implementations for private functions
+/****************************************************************************
+ Function
+   InitList
+ Parameters
+   uint8_t WhichList : number of the distribution list
+   uint8_t const *Members : the service numbers from DIST_LISTn
+   uint8_t NumMembers : number of elements in the Members array
+ Returns
+   None
+ Description
+   converts the list of service numbers into the list's service mask
+ Notes
+   out of range service numbers are ignored
+ Author
+   Team, 10/17/26
+****************************************************************************/
+static void InitList(uint8_t WhichList, uint8_t const *Members, uint8_t NumMembers)
+{
+  uint8_t i;
+  DistListMasks[WhichList] = 0;
+  for (i = 0; i < NumMembers; i++)
   {
-    return true;
+    (void)ES_AddToDistList(WhichList, Members[i]);
   }
 }
 
@@ -13,6 +13,8 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26 09:10 Team     widened Tflag_t to 32 bits to double the number of
+                         timers
  10/27/14 14:02 jec      moved ticking of 'time' to ES_Port to allow it to tick
                          even while blocking. required change to ES_GetTime too
  10/20/13 10:48 jec      moved definition of BITS_PER_BYTE to ES_General.h
@@ -62,7 +64,7 @@
    the initialization of TMR_TimerArray and TMR_MaskArray
 */
 
-typedef uint16_t Tflag_t;
+typedef uint32_t Tflag_t;
 
 typedef uint16_t Timer_t; // sets size of timers to 16 bits
 
@@ -71,6 +73,22 @@ typedef uint16_t Timer_t; // sets size of timers to 16 bits
 /*---------------------------- Module Variables ---------------------------*/
 static Timer_t TMR_TimerArray[sizeof(Tflag_t) * BITS_PER_BYTE] =
 {
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
+  0x0,
   0x0,
   0x0,
   0x0,
@@ -108,7 +126,23 @@ static pPostFunc const Timer2PostFunc[sizeof(Tflag_t) * BITS_PER_BYTE] =
   TIMER12_RESP_FUNC,
   TIMER13_RESP_FUNC,
   TIMER14_RESP_FUNC,
-  TIMER15_RESP_FUNC
+  TIMER15_RESP_FUNC,
+  TIMER16_RESP_FUNC,
+  TIMER17_RESP_FUNC,
+  TIMER18_RESP_FUNC,
+  TIMER19_RESP_FUNC,
+  TIMER20_RESP_FUNC,
+  TIMER21_RESP_FUNC,
+  TIMER22_RESP_FUNC,
+  TIMER23_RESP_FUNC,
+  TIMER24_RESP_FUNC,
+  TIMER25_RESP_FUNC,
+  TIMER26_RESP_FUNC,
+  TIMER27_RESP_FUNC,
+  TIMER28_RESP_FUNC,
+  TIMER29_RESP_FUNC,
+  TIMER30_RESP_FUNC,
+  TIMER31_RESP_FUNC
 };
 
 /*------------------------------ Module Code ------------------------------*/
@@ -183,15 +183,17 @@ void _mon_putc (char c)
 /*******************************************************************************
  * Function: Terminal_MoveBuffer2UART
  * Arguments: none
- * Returns none
+ * Returns bool: true if bytes are still waiting in the circular buffer
  * 
  * Created by: Ed Carryer
  * Description: this functions pulls bytes, if any available, from the
  *              circular buffer and stuffs them into the UART1 buffer
  *              until we either run out of bytes in the circular buffer
  *              or we run out of space in the UART FIFO
+ *              (10/17/26 Team: returns whether bytes remain so that the
+ *              framework knows not to go idle while output is pending)
  ******************************************************************************/
-void Terminal_MoveBuffer2UART( void )
+bool Terminal_MoveBuffer2UART( void )
 {
   while ( (!circular_buf_empty(xmitBufferHandle)) && (!U1STAbits.UTXBF))
   {
@@ -199,6 +201,7 @@ void Terminal_MoveBuffer2UART( void )
     circular_buf_get(xmitBufferHandle, &byte2Xmit);
     U1TXREG = byte2Xmit;
   }
+  return !circular_buf_empty(xmitBufferHandle);
 }
 
 void __attribute__((noreturn)) _fassert(int nLineNumber,
@@ -0,0 +1,839 @@
+/****************************************************************************
+ Module
+   BeaconDetectBench.c
+
+ Revision
+   1.0.0
+
+ Description
+   Host-side regression bench for beacon detection. Synthesises the
+   phototransistor comparator's rising edges for a set of scenarios, runs
+   them through a model of IC1 (every 16th edge captured against Timer3,
+   interrupt on every IC_CAPTURES_PER_INT-th capture) and feeds the
+   captures to the real InputCaptureISR, BeaconEdgeBottomHalf and
+   RunBeaconDetectFSM from ProjectSource/BeaconDetectFSM.c.
+
+   Per scenario it reports:
+     - detection rate: trials that locked the expected beacon
+     - lock latency: from the beacon coming into view to ES_BEACON_DETECTED
+     - false locks: ES_BEACON_DETECTED for any other beacon, per trial
+     - CPU cost: host ns spent in the ISR, bottom half and FSM, per capture
+       and per raw signal edge
+
+   Run it before and after any classifier change and compare the tables.
+
+ Notes
+   Build and run from LeaderPIC.X (HostSim must come first so its xc.h
+   stands in for the device header):
+
+     gcc -std=gnu99 -O2 -IHostSim -IFrameworkHeaders -IProjectHeaders \
+         HostSim/BeaconDetectBench.c ProjectSource/BeaconDetectFSM.c \
+         ProjectSource/CommonDefinitions.c FrameworkSource/ES_LookupTables.c \
+         -lm -o beacon_bench
+     ./beacon_bench [seed] [-v]
+
+   -v passes the FSM's DB_printf output through.
+
+   Signal model, per edge:
+     - beacon: square wave at the beacon frequency (plus a frequency
+       error), Gaussian timing jitter, random dropouts
+     - rotation: the beacon is only seen while the robot's front is within
+       the beam half width of it; the amplitude falls off as a cosine
+       towards the edges of the beam and edges go missing as it nears the
+       comparator threshold
+     - ambient: random glitch edges (Poisson) and 120 Hz lamp flicker. An
+       ambient edge while the beacon holds the line high makes no rising
+       edge, which is where the beacon duty cycle comes in
+
+   The ISR runs at the capture time plus ISR_LATENCY_NS; the bottom half
+   and FSM run straight after it, and 1 ms timer ticks are interleaved in
+   time order. CPU cost is host time, for comparing runs on one machine,
+   not PIC32 cycles.
+
+   Not part of the MPLAB project.
+
+ Baseline
+   Recorded against the whole-period classifier (BeaconDetectFSM.c,
+   10/17/26), built with the command above and run as
+   ./beacon_bench 1, 2 and 3, 20 trials per scenario:
+
+     scenario               detect         lat avg (ms)      false/trial
+     G clean static         100/100/100%   36.0/35.9/35.9    0
+     B clean static         100/100/100%   84.2/84.4/83.6    0
+     R clean static         100/100/100%   132.1/132.2/132.1 0
+     L clean static         100/100/100%   57.8/60.2/61.8    0
+     R +2% jitter drop      100/100/100%   353/359/370       0
+     L jitter drop          90/85/75%      378/290/331       0
+     G ambient 200/s        100/100/100%   41.2/45.5/43.7    0
+     B ambient 500/s        100/100/100%   155/151/162       0
+     ambient only 500/s     -              -                 0
+     ambient only 2000/s    -              -                 0
+     R sweep 90 dps         95/80/80%      199/203/207       0
+     G sweep 180 dps        100/100/100%   86.8/81.8/80.9    0
+     B sweep 180 dps        55/60/45%      138/136/143       0
+
+   A classifier change must not make any row worse than this. The ns
+   columns are host time and vary by tens of percent from run to run, so
+   they are left out.
+
+   Known weak spots:
+     - R +2%: a beacon 2% off its nominal frequency is 0.3 of a period
+       out after 16 periods, so it fails the period test and only gets the
+       agreement test's weak votes. It needs four bursts to lock, about
+       2.7x the clean R latency. Letting the agreement test vote strong
+       brings this down to ~180 ms, but then ambient edges and lamp
+       flicker false lock again (0.05-0.15 per trial on seeds 5-12).
+     - B sweep 180 dps: the beam passes in about 4-5 B bursts, so whether
+       two of them are clean enough to lock varies a lot with the seed
+       (45-60% here, 59.8% averaged over seeds 1-30).
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26       Team    Initial creation
+ 10/17/26       Team    emptying the IC1 FIFO clears ICOV, as on the part
+ 10/17/26       Team    recorded the baseline numbers
+ 10/17/26       Team    re-recorded the baseline against the whole-period
+                        classifier
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "BeaconDetectFSM.h"
+#include "MainLogicFSM.h"
+#include "DCMotorService.h"
+#include "CommonDefinitions.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#undef printf   // dbprintf.h maps printf to DB_printf
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NS_PER_S          1000000000ULL
+#define NS_PER_MS         1000000ULL
+#define TIMER3_NS         (NS_PER_S / TIMER3_CLOCK_HZ)   // 12800 ns per tick
+#define IC_FIFO_DEPTH     4
+#define IC_CAPTURES_PER_INT 4   // must match BeaconDetectFSM.c
+#define ISR_LATENCY_NS    2000ULL
+#define NUM_SIM_TIMERS    16
+#define EVENT_QUEUE_SIZE  16
+#define MAX_EDGES         20000
+#define MAX_LOCKS         64
+#define TRIALS_PER_SCENARIO 20
+#define QUIET_GAP_MS      500u    // silence between trials, > watchdog
+#define LAMP_FLICKER_HZ   120.0
+
+typedef struct
+{
+  const char *Name;
+  uint16_t    BeaconFreq_Hz;     // 0 = no beacon in the scene
+  float       FreqError_pct;     // beacon oscillator error
+  float       Duty;              // fraction of the period the beacon is high
+  float       Jitter_us;         // rms edge jitter
+  float       Dropout;           // probability a beacon edge is missed
+  float       AmbientRate_Hz;    // random glitch edges
+  bool        LampFlicker;       // 120 Hz flicker edges
+  float       Rotation_dps;      // 0 = static, beacon in view throughout
+  float       BeamHalfWidth_deg; // half width of the beam seen by the robot
+  uint16_t    Duration_ms;
+  char        ExpectedId;        // 0 = nothing should lock
+} Scenario_t;
+
+typedef struct
+{
+  uint64_t Time_ns;
+  uint16_t Param;
+} LockRecord_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void     RunScenario(const Scenario_t *pScenario);
+static uint32_t SynthesiseEdges(const Scenario_t *pScenario, uint64_t Start_ns,
+                                uint64_t *pVisible_ns);
+static void     SimulateUntil(uint64_t End_ns, uint32_t NumEdges);
+static void     AdvanceClock(uint64_t Now_ns);
+static void     RunInterrupt(void);
+static void     DispatchEvents(void);
+static void     ProcessTick(void);
+static uint64_t HostNs(void);
+static uint32_t Rand32(void);
+static double   RandUniform(void);
+static double   RandGauss(void);
+static int      CompareEdges(const void *a, const void *b);
+
+// the real IC1 ISR, a plain function under HostSim/sys/attribs.h
+void InputCaptureISR(void);
+
+/*---------------------------- Module Variables ---------------------------*/
+// simulated SFRs declared in HostSim/xc.h
+SimTxCONbits_t    T3CONbits;
+SimICxCONbits_t   IC1CONbits;
+SimIntBits_t      IFS0bits;
+SimIntBits_t      IEC0bits;
+SimIntBits_t      IPC1bits;
+SimIntBits_t      IPC3bits;
+SimIntBits_t      TRISBbits;
+SimIntBits_t      ANSELBbits;
+volatile uint32_t TMR3;
+volatile uint32_t PR3;
+volatile uint32_t IC1R;
+volatile uint32_t IFS0CLR;
+
+// framework state normally in ES_Port.c
+volatile uint32_t        _HW_PendingWork;
+static BottomHalfFunc_t *BottomHalves[32];
+
+// bench state
+static bool       Verbose = false;
+static uint32_t   RandState = 2463534242u;
+static uint64_t   SimNow_ns = 0;
+static uint64_t   NextTick_ns = NS_PER_MS;
+static uint32_t   SimMs = 0;
+static uint32_t   TimerExpiry[NUM_SIM_TIMERS];   // 0 = not running
+
+static uint64_t   Edges[MAX_EDGES];
+static uint16_t   IcFifo[IC_FIFO_DEPTH];
+static uint8_t    IcFifoCount = 0;
+static uint8_t    PrescaleCount = 0;
+
+static ES_Event_t EventQueue[EVENT_QUEUE_SIZE];
+static uint8_t    QueueHead = 0;
+static uint8_t    QueueCount = 0;
+
+static LockRecord_t Locks[MAX_LOCKS];
+static uint8_t      NumLocks = 0;
+
+// cost accounting for the current scenario
+static uint64_t   HandlerNs = 0;
+static uint32_t   NumCaptures = 0;
+
+static const Scenario_t Scenarios[] = {
+  // name                    freq  err% duty  jit  drop  amb    lamp   rot  beam  ms   expect
+  { "G clean static",        3333, 0.0f, 0.5f, 0.0f, 0.00f,   0.0f, false,   0.0f,  0.0f,  800, 'g' },
+  { "B clean static",        1427, 0.0f, 0.5f, 0.0f, 0.00f,   0.0f, false,   0.0f,  0.0f,  800, 'b' },
+  { "R clean static",         909, 0.0f, 0.5f, 0.0f, 0.00f,   0.0f, false,   0.0f,  0.0f, 1000, 'r' },
+  { "L clean static",        2000, 0.0f, 0.5f, 0.0f, 0.00f,   0.0f, false,   0.0f,  0.0f,  800, 'l' },
+  { "R +2% jitter drop",      909, 2.0f, 0.3f, 40.0f, 0.05f,  0.0f, false,   0.0f,  0.0f, 1000, 'r' },
+  { "L jitter drop",         2000, 0.0f, 0.3f, 40.0f, 0.10f,  0.0f, false,   0.0f,  0.0f,  800, 'l' },
+  { "G ambient 200/s",       3333, 0.0f, 0.5f, 10.0f, 0.02f, 200.0f, true,   0.0f,  0.0f,  800, 'g' },
+  { "B ambient 500/s",       1427, 0.0f, 0.2f, 10.0f, 0.02f, 500.0f, true,   0.0f,  0.0f,  800, 'b' },
+  { "ambient only 500/s",       0, 0.0f, 0.5f, 0.0f, 0.00f, 500.0f, true,   0.0f,  0.0f, 2000,  0  },
+  { "ambient only 2000/s",      0, 0.0f, 0.5f, 0.0f, 0.00f,2000.0f, true,   0.0f,  0.0f, 2000,  0  },
+  { "R sweep 90 dps",         909, 0.0f, 0.5f, 10.0f, 0.02f, 100.0f, true,  90.0f, 15.0f, 1000, 'r' },
+  { "G sweep 180 dps",       3333, 0.0f, 0.5f, 10.0f, 0.02f, 100.0f, true, 180.0f, 15.0f,  600, 'g' },
+  { "B sweep 180 dps",       1427, 0.0f, 0.5f, 10.0f, 0.02f, 100.0f, true, 180.0f, 15.0f,  600, 'b' },
+};
+#define NUM_SCENARIOS (sizeof(Scenarios) / sizeof(Scenarios[0]))
+
+/*------------------------------ Module Code ------------------------------*/
+int main(int argc, char *argv[])
+{
+  int     i;
+  uint8_t s;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-v") == 0)
+    {
+      Verbose = true;
+    }
+    else
+    {
+      RandState = (uint32_t)strtoul(argv[i], NULL, 0);
+      if (RandState == 0)
+      {
+        RandState = 1;  // xorshift must not start at 0
+      }
+    }
+  }
+
+  InitBeaconDetectFSM(0);
+  DispatchEvents();
+
+  printf("%-22s %6s %9s %9s %8s %9s %9s\n", "scenario", "detect",
+      "lat avg", "lat max", "false/t", "ns/capt", "ns/edge");
+  for (s = 0; s < NUM_SCENARIOS; s++)
+  {
+    RunScenario(&Scenarios[s]);
+  }
+  return 0;
+}
+
+/***************************************************************************
+ Stand-ins for the framework and the other services
+ ***************************************************************************/
+bool ES_PostToService(uint8_t WhichService, ES_Event_t ThisEvent)
+{
+  (void)WhichService;
+  if (QueueCount >= EVENT_QUEUE_SIZE)
+  {
+    return false;
+  }
+  EventQueue[(QueueHead + QueueCount) % EVENT_QUEUE_SIZE] = ThisEvent;
+  QueueCount++;
+  return true;
+}
+
+ES_TimerReturn_t ES_Timer_InitTimer(uint8_t Num, uint16_t NewTime)
+{
+  if (Num >= NUM_SIM_TIMERS)
+  {
+    return ES_Timer_ERR;
+  }
+  TimerExpiry[Num] = SimMs + NewTime;
+  return ES_Timer_OK;
+}
+
+ES_TimerReturn_t ES_Timer_StopTimer(uint8_t Num)
+{
+  if (Num >= NUM_SIM_TIMERS)
+  {
+    return ES_Timer_ERR;
+  }
+  TimerExpiry[Num] = 0;
+  return ES_Timer_OK;
+}
+
+bool _HW_RegisterBottomHalf(uint8_t WhichBH, BottomHalfFunc_t *Handler)
+{
+  if (WhichBH >= 32)
+  {
+    return false;
+  }
+  BottomHalves[WhichBH] = Handler;
+  return true;
+}
+
+// the bench has no ISR nesting to account for
+void _HW_ISRProfileEnter(uint8_t WhichISR)
+{
+  (void)WhichISR;
+}
+
+void _HW_ISRProfileExit(uint8_t WhichISR)
+{
+  (void)WhichISR;
+}
+
+bool PostMainLogicFSM(ES_Event_t ThisEvent)
+{
+  if ((ThisEvent.EventType == ES_BEACON_DETECTED) && (NumLocks < MAX_LOCKS))
+  {
+    Locks[NumLocks].Time_ns = SimNow_ns;
+    Locks[NumLocks].Param   = ThisEvent.EventParam;
+    NumLocks++;
+  }
+  return true;
+}
+
+uint32_t DCMotor_GetICEventCount(uint8_t motorIndex)
+{
+  (void)motorIndex;
+  return 0;
+}
+
+void DB_printf(const char *Format, ...)
+{
+  va_list args;
+
+  if (Verbose)
+  {
+    va_start(args, Format);
+    vprintf(Format, args);
+    va_end(args);
+  }
+}
+
+uint32_t SimPopIC1BUF(void)
+{
+  uint16_t capture = IcFifo[0];
+
+  if (IcFifoCount > 0)
+  {
+    memmove(&IcFifo[0], &IcFifo[1], (IC_FIFO_DEPTH - 1) * sizeof(IcFifo[0]));
+    IcFifoCount--;
+  }
+  IC1CONbits.ICBNE = (IcFifoCount > 0);
+  if (IcFifoCount == 0)
+  {
+    IC1CONbits.ICOV = 0;    // emptying the FIFO clears the overflow
+  }
+  return capture;
+}
+
+uint32_t SimCoreCount(void)
+{
+  return (uint32_t)(HostNs() / 50u);  // 20 MHz core timer
+}
+
+/***************************************************************************
+ Private Functions
+ ***************************************************************************/
+
+/****************************************************************************
+ Function
+     RunScenario
+
+ Parameters
+     const Scenario_t *pScenario - the scenario to run
+
+ Returns
+     None
+
+ Description
+     Runs TRIALS_PER_SCENARIO trials, each with fresh random edges and a
+     quiet gap before it so the FSM starts from NoSignal, and prints one
+     result row.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void RunScenario(const Scenario_t *pScenario)
+{
+  uint8_t  trial;
+  uint8_t  i;
+  uint8_t  detected = 0;
+  uint32_t falseLocks = 0;
+  uint32_t totalEdges = 0;
+  uint64_t latencySum = 0;
+  uint64_t latencyMax = 0;
+  uint64_t start;
+  uint64_t visible;
+  uint32_t numEdges;
+  bool     found;
+
+  HandlerNs   = 0;
+  NumCaptures = 0;
+
+  for (trial = 0; trial < TRIALS_PER_SCENARIO; trial++)
+  {
+    // let the watchdog drop the FSM back to NoSignal
+    SimulateUntil(SimNow_ns + QUIET_GAP_MS * NS_PER_MS, 0);
+    NumLocks = 0;
+
+    start    = SimNow_ns;
+    numEdges = SynthesiseEdges(pScenario, start, &visible);
+    totalEdges += numEdges;
+    SimulateUntil(start + pScenario->Duration_ms * NS_PER_MS, numEdges);
+
+    found = false;
+    for (i = 0; i < NumLocks; i++)
+    {
+      if ((pScenario->ExpectedId != 0) &&
+          (Locks[i].Param == (uint16_t)pScenario->ExpectedId))
+      {
+        if (!found)
+        {
+          uint64_t latency = (Locks[i].Time_ns > visible) ?
+              (Locks[i].Time_ns - visible) : 0;
+          latencySum += latency;
+          if (latency > latencyMax)
+          {
+            latencyMax = latency;
+          }
+          found = true;
+        }
+      }
+      else
+      {
+        falseLocks++;
+      }
+    }
+    if (found)
+    {
+      detected++;
+    }
+  }
+
+  printf("%-22s %5u%% ", pScenario->Name,
+      (unsigned)((detected * 100u) / TRIALS_PER_SCENARIO));
+  if ((pScenario->ExpectedId != 0) && (detected > 0))
+  {
+    printf("%6.1f ms %6.1f ms ", (double)latencySum / detected / NS_PER_MS,
+        (double)latencyMax / NS_PER_MS);
+  }
+  else
+  {
+    printf("%9s %9s ", "-", "-");
+  }
+  printf("%8.2f %9.0f %9.1f\n", (double)falseLocks / TRIALS_PER_SCENARIO,
+      NumCaptures ? (double)HandlerNs / NumCaptures : 0.0,
+      totalEdges ? (double)HandlerNs / totalEdges : 0.0);
+}
+
+/****************************************************************************
+ Function
+     SynthesiseEdges
+
+ Parameters
+     const Scenario_t *pScenario - signal description
+     uint64_t Start_ns - trial start
+     uint64_t *pVisible_ns - set to when the beacon comes into view
+
+ Returns
+     uint32_t - number of rising edges written to Edges[], sorted
+
+ Description
+     Builds the comparator's rising edges for one trial. In a sweep the
+     robot starts 20 degrees before the beam and turns through it.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint32_t SynthesiseEdges(const Scenario_t *pScenario, uint64_t Start_ns,
+                                uint64_t *pVisible_ns)
+{
+  const double duration = pScenario->Duration_ms / 1000.0;
+  const bool   rotating = (pScenario->Rotation_dps > 0.0f);
+  const double startAngle = -(pScenario->BeamHalfWidth_deg + 20.0);
+  uint32_t     n = 0;
+  double       period = 0.0;
+  double       t;
+
+  *pVisible_ns = Start_ns;
+  if (rotating)
+  {
+    *pVisible_ns = Start_ns + (uint64_t)(20.0 / pScenario->Rotation_dps * NS_PER_S);
+  }
+
+  if (pScenario->BeaconFreq_Hz != 0)
+  {
+    period = 1.0 / (pScenario->BeaconFreq_Hz *
+                    (1.0 + pScenario->FreqError_pct / 100.0));
+    // random phase so captures do not line up with the tick
+    for (t = RandUniform() * period; (t < duration) && (n < MAX_EDGES); t += period)
+    {
+      double p = 1.0 - pScenario->Dropout;
+      if (rotating)
+      {
+        double angle = startAngle + pScenario->Rotation_dps * t;
+        double amplitude = (fabs(angle) < pScenario->BeamHalfWidth_deg) ?
+            cos(1.5707963 * angle / pScenario->BeamHalfWidth_deg) : 0.0;
+        // edges thin out between 30% and 70% of full amplitude
+        double seen = (amplitude - 0.3) / 0.4;
+        p *= (seen < 0.0) ? 0.0 : ((seen > 1.0) ? 1.0 : seen);
+      }
+      if (RandUniform() < p)
+      {
+        double edge = t + RandGauss() * pScenario->Jitter_us * 1e-6;
+        if (edge >= 0.0)
+        {
+          Edges[n++] = Start_ns + (uint64_t)(edge * NS_PER_S);
+        }
+      }
+    }
+  }
+
+  // ambient edges, masked while the beacon holds the line high
+  {
+    double flickerPhase = RandUniform() / LAMP_FLICKER_HZ;
+    double nextFlicker = pScenario->LampFlicker ? flickerPhase : duration;
+    double nextGlitch = (pScenario->AmbientRate_Hz > 0.0f) ?
+        -log(1.0 - RandUniform()) / pScenario->AmbientRate_Hz : duration;
+
+    while (n < MAX_EDGES)
+    {
+      bool flicker = (nextFlicker <= nextGlitch);
+      t = flicker ? nextFlicker : nextGlitch;
+      if (t >= duration)
+      {
+        break;
+      }
+      if (flicker)
+      {
+        nextFlicker += 1.0 / LAMP_FLICKER_HZ;
+      }
+      else
+      {
+        nextGlitch += -log(1.0 - RandUniform()) / pScenario->AmbientRate_Hz;
+      }
+      if ((period > 0.0) && (fmod(t, period) < pScenario->Duty * period))
+      {
+        bool beaconInView = true;
+        if (rotating)
+        {
+          double angle = startAngle + pScenario->Rotation_dps * t;
+          beaconInView = (fabs(angle) < pScenario->BeamHalfWidth_deg);
+        }
+        if (beaconInView)
+        {
+          continue;
+        }
+      }
+      Edges[n++] = Start_ns + (uint64_t)(t * NS_PER_S);
+    }
+  }
+
+  qsort(Edges, n, sizeof(Edges[0]), CompareEdges);
+  return n;
+}
+
+/****************************************************************************
+ Function
+     SimulateUntil
+
+ Parameters
+     uint64_t End_ns - simulated time to run to
+     uint32_t NumEdges - rising edges in Edges[] to play
+
+ Returns
+     None
+
+ Description
+     Plays the edges through the IC1 model in time order with the 1 ms
+     ticks. Every IC_PRESCALE-th edge is captured; IC1 interrupts once
+     IC_CAPTURES_PER_INT captures are buffered.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void SimulateUntil(uint64_t End_ns, uint32_t NumEdges)
+{
+  uint32_t edge = 0;
+
+  while (true)
+  {
+    uint64_t nextEdge = (edge < NumEdges) ? Edges[edge] : UINT64_MAX;
+
+    if ((NextTick_ns <= nextEdge) && (NextTick_ns <= End_ns))
+    {
+      AdvanceClock(NextTick_ns);
+      NextTick_ns += NS_PER_MS;
+      ProcessTick();
+    }
+    else if (nextEdge <= End_ns)
+    {
+      AdvanceClock(nextEdge);
+      edge++;
+      if (++PrescaleCount >= IC_PRESCALE)
+      {
+        PrescaleCount = 0;
+        if (IcFifoCount < IC_FIFO_DEPTH)
+        {
+          IcFifo[IcFifoCount++] = (uint16_t)TMR3;
+          IC1CONbits.ICBNE = 1;
+        }
+        else
+        {
+          IC1CONbits.ICOV = 1;
+        }
+        if (IcFifoCount >= IC_CAPTURES_PER_INT)
+        {
+          AdvanceClock(nextEdge + ISR_LATENCY_NS);
+          RunInterrupt();
+        }
+      }
+    }
+    else
+    {
+      AdvanceClock(End_ns);
+      break;
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+     AdvanceClock
+
+ Parameters
+     uint64_t Now_ns - new simulated time
+
+ Returns
+     None
+
+ Description
+     Moves Timer3 on. The Timer3 ISR is assumed to run at once on a
+     rollover, so T3IF is never left pending.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void AdvanceClock(uint64_t Now_ns)
+{
+  uint32_t ticks;
+
+  if (Now_ns > SimNow_ns)
+  {
+    SimNow_ns = Now_ns;
+  }
+  ticks = (uint32_t)(SimNow_ns / TIMER3_NS);
+  TMR3 = ticks & 0xFFFFu;
+  SharedTimer3RolloverCounter = (uint16_t)(ticks >> 16);
+  IFS0bits.T3IF = 0;
+}
+
+/****************************************************************************
+ Function
+     RunInterrupt
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Calls the IC1 ISR, then the bottom halves it raised and the FSM,
+     timing all three.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void RunInterrupt(void)
+{
+  uint64_t start = HostNs();
+  uint32_t pending;
+  uint8_t  bh;
+
+  NumCaptures += IcFifoCount;
+  InputCaptureISR();
+  if (IFS0CLR & _IFS0_T3IF_MASK)
+  {
+    IFS0bits.T3IF = 0;
+  }
+  IFS0CLR = 0;
+
+  pending = _HW_PendingWork;
+  _HW_PendingWork = 0;
+  for (bh = 0; bh < 32; bh++)
+  {
+    if ((pending & (1UL << bh)) && (BottomHalves[bh] != NULL))
+    {
+      BottomHalves[bh]();
+    }
+  }
+  DispatchEvents();
+  HandlerNs += HostNs() - start;
+}
+
+/****************************************************************************
+ Function
+     DispatchEvents
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Runs the FSM on every queued event
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void DispatchEvents(void)
+{
+  ES_Event_t ThisEvent;
+
+  while (QueueCount > 0)
+  {
+    ThisEvent = EventQueue[QueueHead];
+    QueueHead = (QueueHead + 1) % EVENT_QUEUE_SIZE;
+    QueueCount--;
+    RunBeaconDetectFSM(ThisEvent);
+  }
+}
+
+/****************************************************************************
+ Function
+     ProcessTick
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     1 ms tick: posts ES_TIMEOUT for each timer that expires
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void ProcessTick(void)
+{
+  ES_Event_t ThisEvent;
+  uint8_t    i;
+
+  SimMs++;
+  for (i = 0; i < NUM_SIM_TIMERS; i++)
+  {
+    if ((TimerExpiry[i] != 0) && (TimerExpiry[i] == SimMs))
+    {
+      TimerExpiry[i] = 0;
+      ThisEvent.EventType  = ES_TIMEOUT;
+      ThisEvent.EventParam = i;
+      ES_PostToService(0, ThisEvent);
+    }
+  }
+  DispatchEvents();
+}
+
+/****************************************************************************
+ Function
+     HostNs
+
+ Parameters
+     None
+
+ Returns
+     uint64_t - host monotonic time in ns
+
+ Description
+     For the CPU cost figures
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint64_t HostNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+/****************************************************************************
+ Function
+     Rand32, RandUniform, RandGauss
+
+ Description
+     xorshift32, so a seed gives the same edges on any host; uniform in
+     [0, 1) and standard normal (Box-Muller) on top of it.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint32_t Rand32(void)
+{
+  RandState ^= RandState << 13;
+  RandState ^= RandState >> 17;
+  RandState ^= RandState << 5;
+  return RandState;
+}
+
+static double RandUniform(void)
+{
+  return Rand32() / 4294967296.0;
+}
+
+static double RandGauss(void)
+{
+  double u1 = 1.0 - RandUniform();  // (0, 1], safe for log
+  double u2 = RandUniform();
+  return sqrt(-2.0 * log(u1)) * cos(6.283185307 * u2);
+}
+
+static int CompareEdges(const void *a, const void *b)
+{
+  uint64_t ea = *(const uint64_t *)a;
+  uint64_t eb = *(const uint64_t *)b;
+  return (ea > eb) - (ea < eb);
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
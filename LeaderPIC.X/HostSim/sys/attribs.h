@@ -0,0 +1,18 @@
+/****************************************************************************
+ Module
+     sys/attribs.h (host simulation stand-in)
+
+ Description
+     ISRs become plain functions that the HostSim bench calls itself.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26       Team    Initial creation for the beacon detection bench
+*****************************************************************************/
+#ifndef HOSTSIM_ATTRIBS_H
+#define HOSTSIM_ATTRIBS_H
+
+#define __ISR(vector, ipl)
+
+#endif /* HOSTSIM_ATTRIBS_H */
@@ -0,0 +1,87 @@
+/****************************************************************************
+ Module
+     xc.h (host simulation stand-in)
+
+ Description
+     Replaces the XC32 device header when project modules are compiled on
+     the host for HostSim benches. Declares only the PIC32MX170F256B SFRs
+     and intrinsics the simulated modules touch; the bench defines them and
+     drives them (IC1BUF pops the simulated capture FIFO).
+
+ Notes
+     Put HostSim ahead of the project include paths so this file is found
+     instead of the compiler's. Never used in the MPLAB build.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26       Team    Initial creation for the beacon detection bench
+*****************************************************************************/
+#ifndef HOSTSIM_XC_H
+#define HOSTSIM_XC_H
+
+#include <stdint.h>
+
+// one generic bit-field layout per register is enough for the simulation
+typedef struct
+{
+  unsigned ON:1;
+  unsigned TCS:1;
+  unsigned TCKPS:3;
+} SimTxCONbits_t;
+
+typedef struct
+{
+  unsigned ON:1;
+  unsigned ICTMR:1;
+  unsigned ICM:3;
+  unsigned ICI:2;
+  unsigned ICBNE:1;
+  unsigned ICOV:1;
+} SimICxCONbits_t;
+
+typedef struct
+{
+  unsigned T3IF:1;
+  unsigned IC1IF:1;
+  unsigned T3IE:1;
+  unsigned IC1IE:1;
+  unsigned T3IP:3;
+  unsigned T3IS:2;
+  unsigned IC1IP:3;
+  unsigned IC1IS:2;
+  unsigned TRISB2:1;
+  unsigned ANSB2:1;
+} SimIntBits_t;
+
+extern SimTxCONbits_t     T3CONbits;
+extern SimICxCONbits_t    IC1CONbits;
+extern SimIntBits_t       IFS0bits;
+extern SimIntBits_t       IEC0bits;
+extern SimIntBits_t       IPC1bits;
+extern SimIntBits_t       IPC3bits;
+extern SimIntBits_t       TRISBbits;
+extern SimIntBits_t       ANSELBbits;
+extern volatile uint32_t  TMR3;
+extern volatile uint32_t  PR3;
+extern volatile uint32_t  IC1R;
+
+// reading IC1BUF pops the oldest simulated capture
+uint32_t SimPopIC1BUF(void);
+#define IC1BUF SimPopIC1BUF()
+
+// the bench applies writes to IFS0CLR to IFS0bits after each ISR call
+extern volatile uint32_t IFS0CLR;
+#define _IFS0_T3IF_MASK  0x00001000u
+#define _IFS0_IC1IF_MASK 0x00000020u
+
+// core timer, counts at SYSCLK / 2 like the real one
+uint32_t SimCoreCount(void);
+#define _CP0_GET_COUNT() SimCoreCount()
+
+#define __builtin_disable_interrupts() ((void)0)
+#define __builtin_enable_interrupts()  ((void)0)
+#define Nop()                          ((void)0)
+#define _wait()                        ((void)0)
+
+#endif /* HOSTSIM_XC_H */
@@ -11,13 +11,18 @@
   States
       NoSignal       - No valid signal edges are being received.
                        Reported frequency is 0 Hz.
-      SignalDetected - Valid signal edges are being received. Smoothed
-                       frequency is computed and ES_BEACON_DETECTED is
-                       posted to MainLogicFSM when within tolerance.
+      SignalDetected - Valid signal edges are being received. Each burst
+                       of captures votes for a beacon and ES_BEACON_DETECTED
+                       is posted to MainLogicFSM once one wins the vote.
+      BeaconLocked   - A beacon has won the vote and holds it until it
+                       falls below the unlock votes.
 
   Transitions
       NoSignal       --[ES_NEW_SIGNAL_EDGE]--> SignalDetected
+      SignalDetected --[ES_NEW_SIGNAL_EDGE, lock votes]--> BeaconLocked
+      BeaconLocked   --[ES_NEW_SIGNAL_EDGE, below unlock votes]--> SignalDetected
       SignalDetected --[ES_TIMEOUT / SIGNAL_WATCHDOG_TIMER]--> NoSignal
+      BeaconLocked   --[ES_TIMEOUT / SIGNAL_WATCHDOG_TIMER]--> NoSignal
 
  ****************************************************************************/
 
@@ -44,4 +49,11 @@ ES_Event_t RunBeaconDetectFSM(ES_Event_t ThisEvent);
 BeaconState_t QueryBeaconDetectFSM(void);
 char QueryLockedBeaconId(void);
 
+// Bearing estimation while point turning, angles in tenths of a degree.
+// ES_BEACON_BEARING is posted each time a sweep passes a beacon's beam.
+void BeaconDetect_StartSweep(bool clockwise);
+void BeaconDetect_EndSweep(void);
+bool QueryBeaconBearing(char beaconId, uint16_t *pBearing_deg10);
+uint16_t QuerySweepAngle(void);
+
 #endif /* BeaconDetectFSM_H */
\ No newline at end of file
@@ -13,12 +13,19 @@
  When           Who     What/Why
  -------------- ---     --------
  01/28/26       Tianyu  Initial creation for Lab 7
+ 10/17/26       Team    added beacon sensor offset and ICCountToTurnAngle_deg10
+ 10/17/26       Team    added ReciprocalDivide and PeriodToFrequency_Hz
+ 10/17/26       Team    shared ADC scan set with the battery channel
+ 10/17/26       Team    battery channel moved to AN3, RB14 is SCK1
+ 10/17/26       Team    added IntegerSqrt
+ 10/17/26       Team    battery channel only scanned with BATTERY_SENSE
 ****************************************************************************/
 
 #ifndef COMMON_DEFINITIONS_H
 #define COMMON_DEFINITIONS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*----------------------------- Module Defines ----------------------------*/
 
@@ -104,6 +111,10 @@ extern const uint8_t validCommandBytes[21];
 // 45 deg: 45 * 785 / 360 =  98mm
 #define ROTATE_ARC_MM(angle_deg)  ((uint32_t)(angle_deg) * TURN_CIRC_MM / 360u)
 
+// The beacon phototransistor looks 6-7 degrees to the left (CCW) of the
+// robot's front, in tenths of a degree
+#define BEACON_SENSOR_OFFSET_DEG10  65u
+
 // Odometer polling interval during rotation (ms)
 // Short enough to stop promptly, long enough not to flood the event queue
 #define ROTATE_POLL_INTERVAL_MS   10u
@@ -193,6 +204,30 @@ extern const uint8_t validCommandBytes[21];
 #define DEBUG_OUTPUT_PIN_TRIS TRISBbits.TRISB15
 #define DEBUG_OUTPUT_PIN_ANSEL ANSELBbits.ANSB15
 
+// Battery sense on AN3 (RB1, pin 5). RB1 is also PGEC1, the only
+// debugger pair not taken by other I/O, and once it is analog the part can
+// still be programmed but not debugged in circuit. Off by default; turn it
+// on for match builds on a robot with the battery divider fitted.
+#define BATTERY_SENSE         false
+
+// ADC auto-scan set, configured once by NavigationFSM and read by both
+// NavigationFSM (tape sensors) and DCMotorService (battery). ADC_MultiRead
+// returns the results lowest channel first, hence the indexes.
+#if BATTERY_SENSE
+#define ADC_SCAN_PINS         (BIT12HI | BIT11HI | BIT5HI | BIT3HI)
+#define ADC_NUM_CHANNELS      4
+#define ADC_IDX_BATTERY       0   // AN3  (RB1,  pin 5), via divider
+#define ADC_IDX_CENTER_TAPE   1   // AN5  (RB3,  pin 7)
+#define ADC_IDX_RIGHT_TAPE    2   // AN11 (RB13, pin 24)
+#define ADC_IDX_LEFT_TAPE     3   // AN12 (RB12, pin 23)
+#else
+#define ADC_SCAN_PINS         (BIT12HI | BIT11HI | BIT5HI)
+#define ADC_NUM_CHANNELS      3
+#define ADC_IDX_CENTER_TAPE   0   // AN5  (RB3,  pin 7)
+#define ADC_IDX_RIGHT_TAPE    1   // AN11 (RB13, pin 24)
+#define ADC_IDX_LEFT_TAPE     2   // AN12 (RB12, pin 23)
+#endif
+
 /*---------------------------- Module Variables ---------------------------*/
 // Shared Timer3 rollover counter used by BeaconDetectFSM (IC1),
 // DCMotorService IC3 (left encoder) and IC2 (right encoder).
@@ -200,7 +235,11 @@ extern volatile uint16_t SharedTimer3RolloverCounter;
 
 /*---------------------------- Public Functions ---------------------------*/
 
+uint32_t ReciprocalDivide(uint32_t num, uint32_t den);
+uint32_t IntegerSqrt(uint32_t value);
 uint32_t PeriodToSpeed_mm_s(uint32_t period_ticks);
+uint32_t PeriodToFrequency_Hz(uint32_t period_ticks);
 uint32_t ICCountToDistance_mm(uint32_t ic_event_count);
+uint32_t ICCountToTurnAngle_deg10(uint32_t ic_event_sum);
 
 #endif /* COMMON_DEFINITIONS_H */
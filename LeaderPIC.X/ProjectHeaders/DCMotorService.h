@@ -19,6 +19,13 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    DCMotor_StopNow
+ 10/17/26       Team    DCMotor_MoveDistance_mm position mode
+ 10/17/26       Team    DCMotor_EmergencyOff
+ 10/17/26       Team    estimated speed and distance queries
+ 10/17/26       Team    DCMotor_GetBatteryVoltage_mV
+ 10/17/26       Team    DCMotor_SetRampLimits
+ 10/17/26       Team    stall and slip detection fault bits
  02/25/26       Tianyu  Integrated encoder and speed control
  02/03/26       Tianyu  Updated for Lab 8 two-motor control
 *****************************************************************************/
@@ -29,6 +36,14 @@
 #include "ES_Types.h"
 #include <stdint.h>
 
+// Fault bits, EventParam of ES_MOTOR_STALL and ES_WHEEL_SLIP
+#define MOTOR_FAULT_STALL_LEFT   0x01u  // left wheel driven hard, not turning
+#define MOTOR_FAULT_STALL_RIGHT  0x02u
+#define MOTOR_FAULT_SLIP_LEFT    0x04u  // left wheel ran ahead on a straight move
+#define MOTOR_FAULT_SLIP_RIGHT   0x08u
+#define MOTOR_FAULT_STALL_MASK   (MOTOR_FAULT_STALL_LEFT | MOTOR_FAULT_STALL_RIGHT)
+#define MOTOR_FAULT_SLIP_MASK    (MOTOR_FAULT_SLIP_LEFT | MOTOR_FAULT_SLIP_RIGHT)
+
 // Public Function Prototypes
 
 bool InitDCMotorService(uint8_t Priority);
@@ -42,12 +57,22 @@ void DCMotor_SetSpeed_mm_s(uint16_t speedLeft_mm_s,
                            uint16_t speedRight_mm_s,
                            uint8_t  dirLeft,
                            uint8_t  dirRight);
+void DCMotor_MoveDistance_mm(uint16_t distLeft_mm, uint16_t distRight_mm,
+                             uint8_t dirLeft, uint8_t dirRight,
+                             uint16_t maxSpeed_mm_s);
+void DCMotor_SetRampLimits(uint16_t accel_mm_s2, uint16_t decel_mm_s2,
+                           uint16_t jerk_mm_s3);
+void DCMotor_StopNow(void);
+uint16_t DCMotor_GetBatteryVoltage_mV(void);
+uint32_t DCMotor_GetEstimatedSpeed_mm_s(uint8_t motorIndex);
+uint32_t DCMotor_GetEstimatedDistance_mm(uint8_t motorIndex);
 
 // Encoder query function
 uint32_t Encoder_GetLatestPeriod(uint8_t motorIndex);
 uint32_t DCMotor_GetEncoderPeriod(uint8_t motorIndex);
 uint32_t DCMotor_GetICEventCount(uint8_t motorIndex);
 void     DCMotor_ResetICEventCount(uint8_t motorIndex);
+void     DCMotor_EmergencyOff(void);
 
 // Tape sensor public functions
 void TapeSensor_Read(void);           // Read all tape sensors
@@ -50,6 +50,7 @@ void Nav_MoveForward_mm(uint32_t dist_mm);
 void Nav_MoveBackward_mm(uint32_t dist_mm);
 void Nav_StartRotateContinuous(bool clockwise);
 void Nav_Stop(void);
+void Nav_EmergencyStop(void);
 void Nav_MoveForward_mm_Follow(uint32_t dist_mm);
 void Nav_MoveBackward_mm_Follow(uint32_t dist_mm);
 
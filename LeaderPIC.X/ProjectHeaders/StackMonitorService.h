@@ -0,0 +1,25 @@
+/****************************************************************************
+ Module
+     StackMonitorService.h
+
+ Description
+     Header file for the stack high-water monitor service
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26       Team    Initial creation
+*****************************************************************************/
+
+#ifndef StackMonitorService_H
+#define StackMonitorService_H
+
+#include "ES_Types.h"
+
+// Public Function Prototypes
+
+bool InitStackMonitorService(uint8_t Priority);
+bool PostStackMonitorService(ES_Event_t ThisEvent);
+ES_Event_t RunStackMonitorService(ES_Event_t ThisEvent);
+
+#endif /* StackMonitorService_H */
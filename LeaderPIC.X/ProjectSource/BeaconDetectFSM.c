@@ -18,30 +18,48 @@
 
      NoSignal
        |--[ES_NEW_SIGNAL_EDGE]--> SignalDetected
-       |       entry actions: reset timing history, start SIGNAL_WATCHDOG_TIMER
+       |       entry actions: reset timing history, start SIGNAL_WATCHDOG_TIMER,
+       |               vote for the burst
        |--[ES_TIMEOUT / PRINT_FREQUENCY_TIMER]--> NoSignal (self)
                action: print 0 Hz, restart PRINT_FREQUENCY_TIMER
 
      SignalDetected
        |--[ES_NEW_SIGNAL_EDGE]--> SignalDetected (self)
-       |       action: compute smoothed frequency, restart SIGNAL_WATCHDOG_TIMER,
-       |               post ES_BEACON_DETECTED if within tolerance
+       |       action: vote for the burst's beacon, note the edge time,
+       |               post ES_BEACON_DETECTED once a beacon has
+       |               BEACON_LOCK_VOTES of weight in the last
+       |               BEACON_VOTE_WINDOW bursts
        |--[ES_TIMEOUT / SIGNAL_WATCHDOG_TIMER]--> NoSignal
+       |       guard: no edge for SIGNAL_WATCHDOG_INTERVAL (else re-arm)
        |       entry actions: reset timing history
        |--[ES_TIMEOUT / PRINT_FREQUENCY_TIMER]--> SignalDetected (self)
                action: print current frequency, restart PRINT_FREQUENCY_TIMER
 
+     BeaconLocked
+       |--[ES_NEW_SIGNAL_EDGE]--> BeaconLocked (self)
+       |       action: vote, re-lock and post if another beacon wins
+       |--[ES_NEW_SIGNAL_EDGE]--> SignalDetected
+       |       guard: locked beacon below BEACON_UNLOCK_VOTES
+       |--[ES_TIMEOUT / SIGNAL_WATCHDOG_TIMER]--> NoSignal
+
  Notes
-   IC_PRESCALE = 16: IC1 fires on every 16th rising edge, so each time lapse
-   spans 16 signal periods. The correct frequency formula is therefore:
-       frequency = (timerClock * IC_PRESCALE) / timeLapse
+   IC1 captures every IC_PRESCALE (16th) rising edge and interrupts once
+   IC_CAPTURES_PER_INT captures are in its FIFO. The ISR drains the FIFO
+   into BurstLapses, so frequency = (timerClock * IC_PRESCALE) / timeLapse.
 
-   RolloverCounter extends 16-bit Timer3 to a 32-bit virtual timestamp.
-   The IC ISR (priority 7) and Timer3 ISR (priority 6) coordinate to avoid
-   double-counting rollovers at the 0xFFFF boundary.
+   Each burst votes for the beacon whose period a whole number of times
+   fits every lapse (strong vote; all but one lapse gives a weak vote), or
+   failing that, weak for the beacon nearest lapses that agree with each
+   other. A beacon locks at BEACON_LOCK_VOTES of weight in the last
+   BEACON_VOTE_WINDOW votes and unlocks below BEACON_UNLOCK_VOTES.
 
-   Both PRINT_FREQUENCY_TIMER and SIGNAL_WATCHDOG_TIMER must be declared
-   in ES_Configure.h.
+   Between BeaconDetect_StartSweep and BeaconDetect_EndSweep every vote is
+   tagged with the angle turned so far. When a lock ends, the midpoint of
+   its first and last vote angles is the beacon's bearing.
+
+   RolloverCounter extends Timer3 to 32 bits; captures older than one
+   Timer3 period would alias, so the FIFO is flushed on signal loss and
+   bursts with ICOV set are discarded.
 
  History
  When           Who     What/Why
@@ -49,6 +67,25 @@
  02/03/26       Tianyu  Initial creation for Lab 8 beacon detection
  02/19/26       Tianyu  Refactored into BeaconDetectFSM with NoSignal /
                         SignalDetected states and signal watchdog timer
+ 10/17/26       Team    IC1 ISR raises a bottom half instead of posting
+ 10/17/26       Team    IC1 interrupts on every 4th capture; the ISR drains
+                        the FIFO and averages the burst's time lapses
+ 10/17/26       Team    signal watchdog re-armed lazily from edge timestamps
+                        instead of restarted on every edge
+ 10/17/26       Team    replaced first-match + debounce with histogram voting
+                        over recent bursts with lock/unlock hysteresis
+ 10/17/26       Team    beacon bearings from lock entry/exit angles during a
+                        rotation sweep
+ 10/17/26       Team    CalculateFrequency uses the shared reciprocal divide
+ 10/17/26       Team    IC1 ISR profiling brackets
+ 10/17/26       Team    flush IC1 FIFO and edge history on signal loss,
+                        discard bursts that overflowed the FIFO
+ 10/17/26       Team    burst estimate drops the outlying lapse; votes
+                        weighted by burst spread; first burst votes
+ 10/17/26       Team    bursts classified by whole-period matching of
+                        every lapse, agreement test as the fallback
+ 10/17/26       Team    removed the unused confidence query, shorter Notes
+ 10/17/26       Team    post ES_BEACON_BEARING when a sweep passes a beacon
 ****************************************************************************/
 
 /*----------------------------- Include Files -----------------------------*/
@@ -57,6 +94,7 @@
 #include "ES_Timers.h"
 #include "BeaconDetectFSM.h"
 #include "MainLogicFSM.h"
+#include "DCMotorService.h"
 #include "dbprintf.h"
 #include "CommonDefinitions.h"
 #include <xc.h>
@@ -66,10 +104,22 @@
 // Periodic debug-print interval
 #define PRINT_FREQUENCY_INTERVAL  100   // ms
 
-// Watchdog: if no edge arrives within this window, declare signal lost.
-// At 1427 Hz with IC_PRESCALE=16 an edge arrives every ~11 ms, so 50 ms
-// gives roughly 4 missed captures before declaring signal lost.
-#define SIGNAL_WATCHDOG_INTERVAL  50    // ms
+// Watchdog: if no burst arrives within this window, declare signal lost.
+// At 909 Hz with IC_PRESCALE=16 and IC_CAPTURES_PER_INT=4 a burst arrives
+// every ~70 ms, so 150 ms allows one late burst before declaring signal lost.
+#define SIGNAL_WATCHDOG_INTERVAL  150   // ms
+#define SIGNAL_WATCHDOG_TICKS \
+  ((SIGNAL_WATCHDOG_INTERVAL * TIMER3_CLOCK_HZ) / 1000) // in Timer3 ticks
+#define TIMER3_TICKS_PER_MS       (TIMER3_CLOCK_HZ / 1000)
+
+// IC1 interrupts once this many captures are in its FIFO (1-4)
+#define IC_CAPTURES_PER_INT 4
+// depth of the IC1 FIFO, the most lapses one burst can hold
+#define IC_FIFO_DEPTH       4
+
+// Time lapses longer than this (~105 ms) bridge a gap in the signal and are
+// left out of the burst. The slowest beacon spans ~1375 ticks.
+#define IC_STALE_TICKS    0x2000
 
 // Input Capture pin (IC1 mapped to RB2)
 #define IC_PIN_TRIS   TRISBbits.TRISB2
@@ -81,7 +131,7 @@
 #define TIMER_MAX_PERIOD 0xFFFF   // PR3 = 0xFFFF (16-bit timer, full range)
 
 // Timestamp and frequency constants
-#define INVALID_TIME     0xFFFFFFFF  // Sentinel for uninitialized LastCapturedTime
+#define INVALID_TIME     0xFFFFFFFF  // Sentinel for no previous capture
 
 // Beacon detection window
 #define BEACON_G_FREQ    3333   // Hz
@@ -89,32 +139,76 @@
 #define BEACON_R_FREQ    909    // Hz
 #define BEACON_L_FREQ    2000   // Hz
 
+// Beacon periods per Timer3 tick in Q20. A lapse below IC_STALE_TICKS
+// times this stays under 2^32 for beacons up to ~39 kHz
+#define PERIODS_PER_TICK_Q20(freq) \
+  ((uint32_t)(((uint64_t)(freq) << 20) / TIMER3_CLOCK_HZ))
+#define Q20_ONE                   (1UL << 20)
+
 typedef struct {
     uint32_t freq;
     char     id;
+    uint32_t periodsPerTickQ20;  // PERIODS_PER_TICK_Q20(freq)
 } BeaconDef_t;
 
 static const BeaconDef_t BeaconTable[] = {
-    { BEACON_G_FREQ, 'g' },
-    { BEACON_B_FREQ, 'b' },
-    { BEACON_R_FREQ, 'r' },
-    { BEACON_L_FREQ, 'l' },
+    { BEACON_G_FREQ, 'g', PERIODS_PER_TICK_Q20(BEACON_G_FREQ) },
+    { BEACON_B_FREQ, 'b', PERIODS_PER_TICK_Q20(BEACON_B_FREQ) },
+    { BEACON_R_FREQ, 'r', PERIODS_PER_TICK_Q20(BEACON_R_FREQ) },
+    { BEACON_L_FREQ, 'l', PERIODS_PER_TICK_Q20(BEACON_L_FREQ) },
 };
 #define NUM_BEACONS (sizeof(BeaconTable) / sizeof(BeaconTable[0]))
+
+// one IC1 burst as the ISR left it, copied out in one go at task level
+typedef struct {
+    uint32_t Lapses[IC_FIFO_DEPTH]; // BurstLapses, in capture order
+    uint8_t  LapseCount;            // BurstLapseCount
+    uint32_t EdgeTime;              // CapturedTime
+} Burst_t;
 #define BEACON_FREQ_TOLERANCE 100     // 100Hz
 
-// Debouncing: require this many consecutive detections of the same beacon
-// before locking onto it (prevents false positives from noise/bouncing)
-#define BEACON_DEBOUNCE_THRESHOLD 1
+// Voting: a beacon locks with BEACON_LOCK_VOTES of weight in the last
+// BEACON_VOTE_WINDOW bursts and unlocks below BEACON_UNLOCK_VOTES.
+// Bursts come every 4 captures (19-70 ms depending on the beacon), so a
+// lock takes two strong bursts of the same beacon, which is all a
+// 180 deg/s sweep gets through the beam, a strong and a weak one, or four
+// weak ones. Tuned on HostSim/BeaconDetectBench.c.
+#define BEACON_VOTE_WINDOW        7
+#define BEACON_LOCK_VOTES         4
+#define BEACON_UNLOCK_VOTES       2
+#define BURST_WEIGHT_STRONG       3
+#define BURST_WEIGHT_WEAK         1
+// Period test: a lapse is IC_PRESCALE beacon periods, fewer with ambient
+// edges in it and more with missed ones, matched to 1/16 of a period
+#define BURST_MIN_PERIODS         (IC_PRESCALE - 6)
+#define BURST_MAX_PERIODS         (IC_PRESCALE + 4)
+#define PERIOD_MATCH_FRACTION     16
+// Agreement test, as a shift of the longest lapse: >> 3 is two edges in
+// IC_PRESCALE
+#define BURST_AGREE_SHIFT         3
+// histogram bin for bursts that match no beacon
+#define NO_BEACON_BIN             NUM_BEACONS
 
 /*---------------------------- Module Functions ---------------------------*/
 static void     ConfigureICTimer(void);
 static void     ConfigureInputCapture(void);
 static uint32_t CalculateFrequency(uint32_t timeLapse);
 static void     ResetSignalHistory(void);
-static uint32_t UpdateSmoothingFilter(uint32_t currentCapturedTime);
-static int8_t   FindMatchingBeacon(uint32_t frequency);
+static Burst_t  ReadLatestBurst(void);
+static uint8_t  ClassifyTimeLapse(uint32_t timeLapse);
+static uint8_t  MatchBeaconPeriods(const Burst_t *pBurst, uint8_t *pWeight);
+static uint8_t  MatchAgreeingLapses(const Burst_t *pBurst);
+static uint8_t  CastVote(const Burst_t *pBurst);
+static bool     CheckForLock(void);
+static uint8_t  FindLeadingBeacon(void);
+static void     LockBeacon(uint8_t bin);
+static void     EndLock(void);
+static void     RecordBearing(void);
+static uint16_t GetSweepAngle(void);
 static void     HandleCommonTimeout(ES_Event_t ThisEvent);
+static void     BeaconEdgeBottomHalf(void);
+static void     FlushCaptureFifo(void);
+static uint32_t GetTimer3Time(void);
 
 /*---------------------------- Module Variables ---------------------------*/
 // FSM state and priority
@@ -123,20 +217,40 @@ static uint8_t       MyPriority;
 
 // Shared between ISRs and the FSM (must be volatile)
 static volatile uint32_t CapturedTime    = 0;
+// time lapses of the latest IC1 burst in capture order, and how many
+static volatile uint32_t BurstLapses[IC_FIFO_DEPTH];
+static volatile uint8_t  BurstLapseCount = 0;
+// last capture of the previous burst, INVALID_TIME after a flush
+static volatile uint32_t LastEdgeTime    = INVALID_TIME;
 // Note: SharedTimer3RolloverCounter is defined in CommonDefinitions.c
 // and shared by BeaconDetectFSM, DCMotorService IC3 and IC2
 
 // Timing history (only touched in task context, not in ISRs)
-static uint32_t LastCapturedTime  = INVALID_TIME;
-static uint32_t SmoothedTimeLapse = 0;
-static bool     FirstSample       = true;
+// Timer3 time of the last edge that should keep the signal watchdog alive
+static uint32_t LastKickTime      = 0;
 
 // Tracks which beacon is currently locked (set on BeaconLocked entry)
-static char LockedBeaconId = 0;
-
-// Debouncing variables
-static char     CandidateBeaconId = 0;      // Beacon ID currently being validated
-static uint8_t  BeaconMatchCount  = 0;      // Consecutive detections of CandidateBeaconId
+static char    LockedBeaconId = 0;
+static uint8_t LockedBin      = NO_BEACON_BIN;
+
+// Vote history: the bins and weights of the last BEACON_VOTE_WINDOW bursts
+// and the histogram of those weights (last entry is NO_BEACON_BIN)
+static uint8_t  VoteRing[BEACON_VOTE_WINDOW];
+static uint8_t  VoteWeight[BEACON_VOTE_WINDOW];
+static uint8_t  VoteHead = 0;
+static uint8_t  VoteCounts[NUM_BEACONS + 1];
+// sweep angle (deg10) at each vote in VoteRing
+static uint16_t VoteAngle[BEACON_VOTE_WINDOW];
+
+// Bearing estimation during a rotation sweep, angles in tenths of a degree
+// measured from the start of the sweep in the sweep direction
+static bool     SweepActive      = false;
+static bool     SweepClockwise   = false;
+static uint32_t SweepStartCounts = 0;   // sum of both wheels' IC events
+static uint16_t LockEntryAngle   = 0;   // first vote of the current lock
+static uint16_t LockExitAngle    = 0;   // latest vote of the current lock
+static uint16_t BeaconBearing[NUM_BEACONS]; // robot front faces the beacon
+static uint16_t BeaconSpan[NUM_BEACONS];    // exit - entry, 0 = not seen
 
 /*------------------------------ Module Code ------------------------------*/
 
@@ -173,12 +287,16 @@ bool InitBeaconDetectFSM(uint8_t Priority)
   // Configure Timer3 as the IC time base
   ConfigureICTimer();
 
+  // The IC1 ISR hands its edges to us through a bottom half
+  _HW_RegisterBottomHalf(BH_BEACON_EDGE, BeaconEdgeBottomHalf);
+
   // Configure Input Capture module 1
   ConfigureInputCapture();
 
   // Initialise timing variables to known-invalid state
   ResetSignalHistory();
   CapturedTime = 0;
+  BurstLapseCount = 0;
 
   // Start the periodic frequency-print timer
   ES_Timer_InitTimer(PRINT_FREQUENCY_TIMER, PRINT_FREQUENCY_INTERVAL);
@@ -238,9 +356,11 @@ bool PostBeaconDetectFSM(ES_Event_t ThisEvent)
 
      SignalDetected state
        ES_NEW_SIGNAL_EDGE  --> stay in SignalDetected; compute smoothed
-                               frequency, restart watchdog, post
+                               frequency, note the edge time, post
                                ES_BEACON_DETECTED if within tolerance.
-       ES_TIMEOUT (WATCHDOG)--> transition to NoSignal; reset timing history.
+       ES_TIMEOUT (WATCHDOG)--> if no edge for SIGNAL_WATCHDOG_INTERVAL,
+                               transition to NoSignal and reset timing
+                               history, else re-arm for the remainder.
        ES_TIMEOUT (PRINT)  --> stay in SignalDetected; print current
                                frequency and restart the print timer.
 
@@ -277,22 +397,27 @@ ES_Event_t RunBeaconDetectFSM(ES_Event_t ThisEvent)
       {
         case ES_NEW_SIGNAL_EDGE:
         {
+          Burst_t burst = ReadLatestBurst();
+
           // First edge after a quiet period — begin tracking
           // Reset all history so the first inter-edge measurement is clean
           ResetSignalHistory();
           
           // Clear any stale beacon ID from previous detections
           LockedBeaconId = 0;
+          LockedBin      = NO_BEACON_BIN;
 
-          // Latch the timestamp recorded by the ISR
-          LastCapturedTime = CapturedTime;
-
-          // Arm the watchdog; it will fire if edges stop arriving
+          // Arm the watchdog once; it checks LastKickTime when it fires
+          // and re-arms itself for as long as edges keep arriving
+          LastKickTime = burst.EdgeTime;
           ES_Timer_InitTimer(SIGNAL_WATCHDOG_TIMER, SIGNAL_WATCHDOG_INTERVAL);
 
-          // Transition to SignalDetected
+          // Transition to SignalDetected. The burst that brought us here
+          // votes too; a sweep may only get two bursts through the beam
           CurrentState = SignalDetected;
           DB_printf("NoSignal -> SignalDetected\r\n");
+          CastVote(&burst);
+          CheckForLock();
         }
         break;
 
@@ -323,59 +448,13 @@ ES_Event_t RunBeaconDetectFSM(ES_Event_t ThisEvent)
       {
         case ES_NEW_SIGNAL_EDGE:
         {
-          uint32_t CurrentCapturedTime = CapturedTime;
-
-          // Kick the watchdog on every arriving edge
-          ES_Timer_InitTimer(SIGNAL_WATCHDOG_TIMER, SIGNAL_WATCHDOG_INTERVAL);
+          Burst_t burst = ReadLatestBurst();
 
-          // Update smoothing filter; returns 0 if not enough data yet
-          uint32_t frequency = UpdateSmoothingFilter(CurrentCapturedTime);
+          // Every arriving edge keeps the watchdog alive
+          LastKickTime = burst.EdgeTime;
 
-          if (frequency > 0)
-          {
-            int8_t beaconIdx = FindMatchingBeacon(frequency);
-            if (beaconIdx >= 0)
-            {
-              char detectedId = BeaconTable[beaconIdx].id;
-              
-              // Debouncing: check if it's the same beacon as before
-              if (detectedId == CandidateBeaconId)
-              {
-                // Same beacon — increment match count
-                BeaconMatchCount++;
-                DB_printf("Beacon '%c' match count: %d/%d\r\n", 
-                    detectedId, BeaconMatchCount, BEACON_DEBOUNCE_THRESHOLD);
-                
-                // Check if we've reached the debounce threshold
-                if (BeaconMatchCount >= BEACON_DEBOUNCE_THRESHOLD)
-                {
-                  // Lock onto this beacon and notify exactly once
-                  LockedBeaconId = detectedId;
-                  ES_Event_t BeaconEvent;
-                  BeaconEvent.EventType  = ES_BEACON_DETECTED;
-                  BeaconEvent.EventParam = LockedBeaconId;
-                  PostMainLogicFSM(BeaconEvent);
-                  CurrentState = BeaconLocked;
-                  DB_printf("SignalDetected -> BeaconLocked ('%c') after %d confirmations\r\n", 
-                      LockedBeaconId, BeaconMatchCount);
-                }
-              }
-              else
-              {
-                // Different beacon detected: restart debounce process
-                CandidateBeaconId = detectedId;
-                BeaconMatchCount  = 1;
-                DB_printf("New candidate beacon '%c', starting debounce count\r\n", detectedId);
-              }
-            }
-            else
-            {
-              // No beacon matched, reset debounce state
-              // DB_printf("Resetting debounce state");
-              CandidateBeaconId = 0;
-              BeaconMatchCount  = 0;
-            }
-          }
+          CastVote(&burst);
+          CheckForLock();
         }
         break;
 
@@ -391,8 +470,8 @@ ES_Event_t RunBeaconDetectFSM(ES_Event_t ThisEvent)
 
     /*--------------------------------------------------------------------
       BeaconLocked: a specific beacon is confirmed; suppress re-posting
-      unless a *different* beacon frequency is detected.
-      Watchdog expiry is the only way back to NoSignal.
+      unless a *different* beacon wins the vote. Losing votes drops back
+      to SignalDetected; watchdog expiry is the only way back to NoSignal.
     --------------------------------------------------------------------*/
     case BeaconLocked:
     {
@@ -400,56 +479,37 @@ ES_Event_t RunBeaconDetectFSM(ES_Event_t ThisEvent)
       {
         case ES_NEW_SIGNAL_EDGE:
         {
-          uint32_t CurrentCapturedTime = CapturedTime;
-          uint32_t frequency = UpdateSmoothingFilter(CurrentCapturedTime);
+          Burst_t burst = ReadLatestBurst();
+          uint8_t bin   = CastVote(&burst);
+
+          if (bin != NO_BEACON_BIN)
+          {
+            // Valid signal — keep the watchdog alive
+            LastKickTime = burst.EdgeTime;
+          }
+          if (bin == LockedBin)
+          {
+            // Still in the beam, push the exit out
+            LockExitAngle = VoteAngle[(VoteHead + BEACON_VOTE_WINDOW - 1) %
+                                      BEACON_VOTE_WINDOW];
+          }
 
-          if (frequency > 0)
+          uint8_t leader = FindLeadingBeacon();
+          if ((leader != NO_BEACON_BIN) &&
+              (BeaconTable[leader].id != LockedBeaconId) &&
+              (VoteCounts[leader] >= BEACON_LOCK_VOTES))
+          {
+            // Another beacon has won the vote — re-lock and notify
+            EndLock();
+            LockBeacon(leader);
+            DB_printf("BeaconLocked -> re-locked to '%c'\r\n", LockedBeaconId);
+          }
+          else if (VoteCounts[LockedBin] < BEACON_UNLOCK_VOTES)
           {
-            int8_t beaconIdx = FindMatchingBeacon(frequency);
-            if (beaconIdx >= 0)
-            {
-              // Valid signal — keep the watchdog alive
-              ES_Timer_InitTimer(SIGNAL_WATCHDOG_TIMER, SIGNAL_WATCHDOG_INTERVAL);
-              char detectedId = BeaconTable[beaconIdx].id;
-
-              if (detectedId == LockedBeaconId)
-              {
-                // Same beacon — clear any pending re-lock candidate
-                CandidateBeaconId = 0;
-                BeaconMatchCount  = 0;
-              }
-              else
-              {
-                // Different beacon — apply debounce before re-locking
-                if (detectedId == CandidateBeaconId)
-                {
-                  BeaconMatchCount++;
-                  DB_printf("BeaconLocked: re-lock candidate '%c' %d/%d\r\n",
-                      detectedId, BeaconMatchCount, BEACON_DEBOUNCE_THRESHOLD);
-
-                  if (BeaconMatchCount >= BEACON_DEBOUNCE_THRESHOLD)
-                  {
-                    // Confirmed new beacon — re-lock and notify
-                    LockedBeaconId    = detectedId;
-                    CandidateBeaconId = 0;
-                    BeaconMatchCount  = 0;
-                    ES_Event_t BeaconEvent;
-                    BeaconEvent.EventType  = ES_BEACON_DETECTED;
-                    BeaconEvent.EventParam = LockedBeaconId;
-                    PostMainLogicFSM(BeaconEvent);
-                    DB_printf("BeaconLocked -> re-locked to '%c'\r\n", LockedBeaconId);
-                  }
-                }
-                else
-                {
-                  // New candidate — reset debounce
-                  CandidateBeaconId = detectedId;
-                  BeaconMatchCount  = 1;
-                  DB_printf("BeaconLocked: new re-lock candidate '%c'\r\n", detectedId);
-                }
-              }
-            }
-            // else: no match — watchdog will expire → NoSignal if signal truly lost
+            // The locked beacon has lost its votes, e.g. rotated out of view
+            DB_printf("BeaconLocked ('%c') -> SignalDetected\r\n", LockedBeaconId);
+            EndLock();
+            CurrentState   = SignalDetected;
           }
         }
         break;
@@ -516,6 +576,122 @@ char QueryLockedBeaconId(void)
   return LockedBeaconId;
 }
 
+/****************************************************************************
+ Function
+     BeaconDetect_StartSweep
+
+ Parameters
+     bool clockwise - direction the robot is about to point turn in
+
+ Returns
+     None
+
+ Description
+     Starts recording beacon bearings. Angles are measured from here, in
+     the sweep direction, and bearings from an earlier sweep are cleared.
+     Call just before starting the rotation.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void BeaconDetect_StartSweep(bool clockwise)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_BEACONS; i++)
+  {
+    BeaconBearing[i] = 0;
+    BeaconSpan[i]    = 0;
+  }
+  SweepClockwise   = clockwise;
+  SweepStartCounts = DCMotor_GetICEventCount(LEFT_MOTOR) +
+                     DCMotor_GetICEventCount(RIGHT_MOTOR);
+  SweepActive      = true;
+
+  // A beacon already locked when the sweep starts enters the beam here
+  LockEntryAngle = 0;
+  LockExitAngle  = 0;
+}
+
+/****************************************************************************
+ Function
+     BeaconDetect_EndSweep
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Stops recording bearings. A beacon still locked counts as leaving the
+     beam at its latest vote.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void BeaconDetect_EndSweep(void)
+{
+  RecordBearing();
+  SweepActive = false;
+}
+
+/****************************************************************************
+ Function
+     QueryBeaconBearing
+
+ Parameters
+     char beaconId - 'g', 'b', 'r' or 'l'
+     uint16_t *pBearing_deg10 - where to put the bearing
+
+ Returns
+     bool - true if the beacon was seen during the last sweep
+
+ Description
+     The bearing is the sweep angle, in tenths of a degree from the start
+     of the sweep in the sweep direction, at which the robot's front faced
+     the beacon. Turning back by QuerySweepAngle() - bearing (against the
+     sweep direction) faces the beacon.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool QueryBeaconBearing(char beaconId, uint16_t *pBearing_deg10)
+{
+  uint8_t i;
+
+  for (i = 0; i < NUM_BEACONS; i++)
+  {
+    if ((BeaconTable[i].id == beaconId) && (BeaconSpan[i] != 0))
+    {
+      *pBearing_deg10 = BeaconBearing[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+/****************************************************************************
+ Function
+     QuerySweepAngle
+
+ Parameters
+     None
+
+ Returns
+     uint16_t - tenths of a degree turned since BeaconDetect_StartSweep
+
+ Description
+     For working out how far to turn back to a bearing
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint16_t QuerySweepAngle(void)
+{
+  return GetSweepAngle();
+}
+
 /***************************************************************************
  Interrupt Service Routines
  ***************************************************************************/
@@ -532,12 +708,23 @@ char QueryLockedBeaconId(void)
 
  Description
      IC1 interrupt response routine (priority 7, higher than Timer3 ISR).
-     Reads IC1BUF, handles the Timer3 rollover boundary race condition,
-     assembles a 32-bit virtual timestamp, and posts ES_NEW_SIGNAL_EDGE.
+     Runs once IC_CAPTURES_PER_INT captures are buffered. Drains IC1BUF,
+     turns each capture into a 32-bit virtual timestamp, leaves the time
+     lapses between them in BurstLapses and raises BH_BEACON_EDGE so that
+     ES_NEW_SIGNAL_EDGE is posted at task level.
+
+     Timestamps are built backwards from the current 32-bit Timer3 time,
+     so a capture that sat in the FIFO across a rollover (which the Timer3
+     ISR may already have counted) still gets the right upper half.
 
-     Race condition handling: if Timer3 has rolled over (T3IF set) AND the
-     captured 16-bit value is in the lower half of the range (i.e., the
-     capture occurred just after the rollover), the rollover is counted here
+     An interrupt with an empty FIFO reports nothing.
+
+     If the FIFO overflowed (ICOV), captures were dropped between the
+     buffered ones, so the burst is drained and discarded and the next
+     burst starts a fresh time lapse.
+
+     Race condition handling: if Timer3 has rolled over (T3IF set) AND
+     TMR3 is in the lower half of the range, the rollover is counted here
      and the Timer3 ISR will see T3IF already cleared and skip it.
 
  Author
@@ -545,24 +732,88 @@ char QueryLockedBeaconId(void)
 ****************************************************************************/
 void __ISR(_INPUT_CAPTURE_1_VECTOR, IPL7SOFT) InputCaptureISR(void)
 {
-  // Read captured timer value from the IC FIFO buffer
-  uint16_t capturedTimer16 = IC1BUF;
+  uint16_t nowTimer16;
+  uint32_t now;
+  uint32_t edgeTime;
+  uint32_t lapse;
+  uint8_t  lapseCount = 0;
 
-  // Clear the IC interrupt flag
-  IFS0CLR = _IFS0_IC1IF_MASK;
+  ES_ISR_ENTER(ISR_PROF_IC1);
+
+  // Nothing buffered, e.g. the FIFO was flushed after the flag was set;
+  // there is no burst to report
+  if (!IC1CONbits.ICBNE)
+  {
+    IFS0CLR = _IFS0_IC1IF_MASK;
+    ES_ISR_EXIT(ISR_PROF_IC1);
+    return;
+  }
 
-  // If Timer3 rolled over and the capture is in the post-rollover region,
-  // handle the rollover here before the Timer3 ISR gets a chance to
-  if (IFS0bits.T3IF && (capturedTimer16 < 0x8000))
+  // Captures were lost; the buffered ones can not be paired up
+  if (IC1CONbits.ICOV)
+  {
+    FlushCaptureFifo();
+    IFS0CLR = _IFS0_IC1IF_MASK;
+    ES_ISR_EXIT(ISR_PROF_IC1);
+    return;
+  }
+
+  // If Timer3 rolled over and its ISR has not run yet, count it here
+  nowTimer16 = TMR3;
+  if (IFS0bits.T3IF && (nowTimer16 < 0x8000))
   {
     SharedTimer3RolloverCounter++;
     IFS0CLR = _IFS0_T3IF_MASK;
   }
+  now = ((uint32_t)SharedTimer3RolloverCounter << 16) | nowTimer16;
+
+  // Drain the FIFO, oldest capture first. Each capture is less than one
+  // Timer3 period old, so the 16-bit difference gives its age exactly
+  while (IC1CONbits.ICBNE)
+  {
+    edgeTime = now - (uint16_t)(nowTimer16 - (uint16_t)IC1BUF);
+    lapse    = edgeTime - LastEdgeTime;
+    if ((LastEdgeTime != INVALID_TIME) && (lapse < IC_STALE_TICKS) &&
+        (lapseCount < IC_FIFO_DEPTH))
+    {
+      BurstLapses[lapseCount++] = lapse;
+    }
+    LastEdgeTime = edgeTime;
+  }
+
+  // Clear the IC interrupt flag now that the FIFO is empty
+  IFS0CLR = _IFS0_IC1IF_MASK;
+
+  CapturedTime    = LastEdgeTime;
+  BurstLapseCount = lapseCount;
 
-  // Assemble the 32-bit virtual timestamp
-  CapturedTime = ((uint32_t)SharedTimer3RolloverCounter << 16) | capturedTimer16;
+  // Notify the FSM that a new burst has been captured. The post itself is
+  // done at task level by BeaconEdgeBottomHalf
+  _HW_RaiseBottomHalf(BH_BEACON_EDGE);
 
-  // Notify the FSM that a new edge has been captured
+  ES_ISR_EXIT(ISR_PROF_IC1);
+}
+
+/****************************************************************************
+ Function
+     BeaconEdgeBottomHalf
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Bottom half of the IC1 ISR, run by _HW_Process_Pending_Ints. Posts
+     ES_NEW_SIGNAL_EDGE; the FSM reads the latest burst from BurstLapses,
+     so bursts raised since the last pass collapse into one.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void BeaconEdgeBottomHalf(void)
+{
   ES_Event_t NewEvent;
   NewEvent.EventType = ES_NEW_SIGNAL_EDGE;
   PostBeaconDetectFSM(NewEvent);
@@ -656,7 +907,8 @@ static void ConfigureICTimer(void)
 
  Description
      Configures IC1 to capture on every 16th rising edge (ICM = 0b101),
-     using Timer3 as its time base (ICTMR = 0). IC1 interrupt priority
+     using Timer3 as its time base (ICTMR = 0), and to interrupt once
+     IC_CAPTURES_PER_INT captures are buffered (ICI). IC1 interrupt priority
      is set higher than Timer3 so the boundary race can be resolved
      deterministically in the IC ISR.
 
@@ -669,14 +921,11 @@ static void ConfigureInputCapture(void)
   IC1CONbits.ON   = 0;    // disable IC module during config
   IC1CONbits.ICTMR = 0;   // use Timer3 as time base
   IC1CONbits.ICM  = 0b101; // capture on every 16th rising edge
+  IC1CONbits.ICI  = IC_CAPTURES_PER_INT - 1; // interrupt on every Nth capture
 
   // Clear any stale IC interrupt flag and drain the FIFO
   IFS0CLR = _IFS0_IC1IF_MASK;
-  volatile uint32_t dummy;
-  while (IC1CONbits.ICBNE)
-  {
-    dummy = IC1BUF;
-  }
+  FlushCaptureFifo();
 
   IPC1bits.IC1IP  = 7;    // priority 7 (higher than Timer3)
   IPC1bits.IC1IS  = 0;    // subpriority 0
@@ -685,6 +934,34 @@ static void ConfigureInputCapture(void)
   T3CONbits.ON    = 1;    // re-enable timer
 }
 
+/****************************************************************************
+ Function
+     FlushCaptureFifo
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Empties IC1BUF (which also clears ICOV) and forgets the last edge
+     time, so the next capture does not form a time lapse with anything
+     before it. Called from the IC1 ISR on overflow and at task level, with
+     the IC1 interrupt masked, when the signal is declared lost.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void FlushCaptureFifo(void)
+{
+  while (IC1CONbits.ICBNE)
+  {
+    (void)IC1BUF;
+  }
+  LastEdgeTime = INVALID_TIME;
+}
+
 /****************************************************************************
  Function
      CalculateFrequency
@@ -700,19 +977,15 @@ static void ConfigureInputCapture(void)
      rising edge, each timeLapse spans IC_PRESCALE signal periods:
          frequency = (timerClock * IC_PRESCALE) / timeLapse
      where timerClock = PBCLK_FREQ / TIMER_PRESCALE = 78,125 Hz.
+     Runs once per burst, so it goes through PeriodToFrequency_Hz rather
+     than the hardware divider.
 
  Author
      Tianyu, 02/03/26
 ****************************************************************************/
 static uint32_t CalculateFrequency(uint32_t timeLapse)
 {
-  if (timeLapse == 0)
-  {
-    return 0;
-  }
-
-  uint32_t timerClock = PBCLK_FREQ / TIMER_PRESCALE; // 78,125 Hz
-  return (timerClock * IC_PRESCALE) / timeLapse;
+  return PeriodToFrequency_Hz(timeLapse);
 }
 
 /****************************************************************************
@@ -726,110 +999,485 @@ static uint32_t CalculateFrequency(uint32_t timeLapse)
      None
 
  Description
-     Clears all timing history variables to their initial invalid state.
-     Called on entry to NoSignal (from SignalDetected via watchdog expiry)
-     and on first entry to SignalDetected (from NoSignal) so that the
-     smoothed average is not contaminated by stale data across transitions.
+     Clears the vote history. Called on entry to NoSignal (via watchdog
+     expiry) and on first entry to SignalDetected (from NoSignal) so that
+     votes are not carried across a gap in the signal. The window starts
+     out full of no-beacon votes of no weight, so a lock always takes
+     BEACON_LOCK_VOTES of fresh weight.
 
  Author
      Tianyu, 02/19/26
 ****************************************************************************/
 static void ResetSignalHistory(void)
 {
-  LastCapturedTime  = INVALID_TIME;
-  SmoothedTimeLapse = 0;
-  FirstSample       = true;
-  
-  // Reset debouncing state
-  CandidateBeaconId = 0;
-  BeaconMatchCount  = 0;
+  uint8_t i;
+
+  for (i = 0; i < BEACON_VOTE_WINDOW; i++)
+  {
+    VoteRing[i]   = NO_BEACON_BIN;
+    VoteWeight[i] = 0;
+  }
+  for (i = 0; i <= NUM_BEACONS; i++)
+  {
+    VoteCounts[i] = 0;
+  }
+  VoteHead = 0;
 }
 
 /****************************************************************************
  Function
-     UpdateSmoothingFilter
+     ReadLatestBurst
 
  Parameters
-     uint32_t currentCapturedTime - the timestamp just latched from CapturedTime
+     None
 
  Returns
-     uint32_t - the smoothed frequency in Hz, or 0 if LastCapturedTime was
-                still INVALID (i.e. this is the very first edge after a reset)
+     Burst_t - copies of BurstLapses, BurstLapseCount and CapturedTime
 
  Description
-     Computes the time lapse from the previous captured edge, updates the
-     exponential moving average (5:1 history weighting), advances
-     LastCapturedTime, and returns the resulting frequency.
-     Extracted to eliminate identical code in SignalDetected and BeaconLocked.
+     Copies them with interrupts off, so an IC1 burst landing part way
+     through can not mix the lapses of two bursts.
 
  Author
-     Tianyu, 02/19/26
+     Team, 10/17/26
+****************************************************************************/
+static Burst_t ReadLatestBurst(void)
+{
+  Burst_t burst;
+  uint8_t i;
+
+  EnterCritical();
+  burst.LapseCount = BurstLapseCount;
+  for (i = 0; i < burst.LapseCount; i++)
+  {
+    burst.Lapses[i] = BurstLapses[i];
+  }
+  burst.EdgeTime   = CapturedTime;
+  ExitCritical();
+  return burst;
+}
+
+/****************************************************************************
+ Function
+     ClassifyTimeLapse
+
+ Parameters
+     uint32_t timeLapse - ticks spanning IC_PRESCALE signal periods
+
+ Returns
+     uint8_t - index into BeaconTable of the beacon nearest in frequency
+               within BEACON_FREQ_TOLERANCE, or NO_BEACON_BIN
+
+ Description
+     Bins an agreeing burst by its frequency. Uses the nearest beacon
+     rather than the first one in range so the table order does not
+     matter.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint8_t ClassifyTimeLapse(uint32_t timeLapse)
+{
+  uint32_t frequency = CalculateFrequency(timeLapse);
+  uint32_t error;
+  uint32_t bestError = BEACON_FREQ_TOLERANCE + 1;
+  uint8_t  bin = NO_BEACON_BIN;
+  uint8_t  i;
+
+  if (frequency == 0)
+  {
+    return NO_BEACON_BIN;
+  }
+  for (i = 0; i < NUM_BEACONS; i++)
+  {
+    error = (frequency > BeaconTable[i].freq) ?
+        (frequency - BeaconTable[i].freq) : (BeaconTable[i].freq - frequency);
+    if (error < bestError)
+    {
+      bestError = error;
+      bin       = i;
+    }
+  }
+  return bin;
+}
+
+/****************************************************************************
+ Function
+     MatchBeaconPeriods
+
+ Parameters
+     const Burst_t *pBurst - the burst to classify
+     uint8_t *pWeight - set to the vote weight when a beacon matches
+
+ Returns
+     uint8_t - index into BeaconTable of the beacon whose whole periods
+               fit the burst's lapses, NO_BEACON_BIN if none or a tie
+
+ Description
+     The period test from the Notes. Each lapse is converted to beacon
+     periods in Q20 with one multiply, so the distance to the nearest
+     whole number of periods is the low 20 bits.
+
+ Author
+     Team, 10/17/26
 ****************************************************************************/
-static uint32_t UpdateSmoothingFilter(uint32_t currentCapturedTime)
+static uint8_t MatchBeaconPeriods(const Burst_t *pBurst, uint8_t *pWeight)
 {
-  uint32_t frequency = 0;
+  uint8_t  bin       = NO_BEACON_BIN;
+  uint8_t  bestCount = 0;
+  uint8_t  matches;
+  uint8_t  i;
+  uint8_t  j;
+  uint32_t periodsQ20;
+  uint32_t periods;
+  uint32_t fraction;
+
+  for (i = 0; i < NUM_BEACONS; i++)
+  {
+    matches = 0;
+    for (j = 0; j < pBurst->LapseCount; j++)
+    {
+      periodsQ20 = pBurst->Lapses[j] * BeaconTable[i].periodsPerTickQ20;
+      periods    = (periodsQ20 + (Q20_ONE / 2)) >> 20;
+      fraction   = periodsQ20 & (Q20_ONE - 1);
+      if (fraction >= (Q20_ONE / 2))
+      {
+        fraction = Q20_ONE - fraction;
+      }
+      if ((periods >= BURST_MIN_PERIODS) && (periods <= BURST_MAX_PERIODS) &&
+          (fraction <= ((Q20_ONE / PERIOD_MATCH_FRACTION) +
+                        (BeaconTable[i].periodsPerTickQ20 / 2))))
+      {
+        matches++;
+      }
+    }
+    if (matches > bestCount)
+    {
+      bestCount = matches;
+      bin       = i;
+    }
+    else if ((matches == bestCount) && (matches != 0))
+    {
+      bin = NO_BEACON_BIN;  // harmonics of two beacons, e.g. 10 B = 14 L
+    }
+  }
 
-  if (LastCapturedTime != INVALID_TIME)
+  if ((bin == NO_BEACON_BIN) || (bestCount < 2) ||
+      (bestCount + 1 < pBurst->LapseCount))
   {
-    uint32_t timeLapse;
-    if (currentCapturedTime >= LastCapturedTime)
+    return NO_BEACON_BIN;
+  }
+  *pWeight = ((bestCount == pBurst->LapseCount) && (bestCount >= 3)) ?
+      BURST_WEIGHT_STRONG : BURST_WEIGHT_WEAK;
+  return bin;
+}
+
+/****************************************************************************
+ Function
+     MatchAgreeingLapses
+
+ Parameters
+     const Burst_t *pBurst - the burst to classify
+
+ Returns
+     uint8_t - index into BeaconTable of the beacon nearest the burst's
+               frequency, NO_BEACON_BIN if its lapses do not agree
+
+ Description
+     The agreement test from the Notes, for beacons off their nominal
+     frequency. Needs at least 3 lapses. A match is always a weak vote.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint8_t MatchAgreeingLapses(const Burst_t *pBurst)
+{
+  uint32_t shortest = 0xFFFFFFFF;
+  uint32_t longest  = 0;
+  uint8_t  j;
+
+  if (pBurst->LapseCount < 3)
+  {
+    return NO_BEACON_BIN;
+  }
+  for (j = 0; j < pBurst->LapseCount; j++)
+  {
+    if (pBurst->Lapses[j] < shortest)
     {
-      timeLapse = currentCapturedTime - LastCapturedTime;
+      shortest = pBurst->Lapses[j];
     }
-    else
+    if (pBurst->Lapses[j] > longest)
     {
-      // Handle 32-bit virtual-timestamp wraparound
-      timeLapse = (0xFFFFFFFF - LastCapturedTime) + currentCapturedTime + 1;
+      longest = pBurst->Lapses[j];
     }
+  }
+  if ((longest - shortest) > (longest >> BURST_AGREE_SHIFT))
+  {
+    return NO_BEACON_BIN;
+  }
+  return ClassifyTimeLapse(longest);
+}
+
+/****************************************************************************
+ Function
+     CastVote
+
+ Parameters
+     const Burst_t *pBurst - the burst from ReadLatestBurst
+
+ Returns
+     uint8_t - the bin voted for, NO_BEACON_BIN if the burst matched no
+               beacon
+
+ Description
+     Bins the burst with the period test, or the agreement test if that
+     finds nothing, then adds the vote to the window, retiring the oldest
+     one, and tags it with the current sweep angle. No-beacon votes carry
+     no weight.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint8_t CastVote(const Burst_t *pBurst)
+{
+  uint8_t weight = 0;
+  uint8_t bin    = MatchBeaconPeriods(pBurst, &weight);
+
+  if (bin == NO_BEACON_BIN)
+  {
+    bin    = MatchAgreeingLapses(pBurst);
+    weight = (bin != NO_BEACON_BIN) ? BURST_WEIGHT_WEAK : 0;
+  }
+
+  VoteCounts[VoteRing[VoteHead]] -= VoteWeight[VoteHead];
+  VoteRing[VoteHead]   = bin;
+  VoteWeight[VoteHead] = weight;
+  VoteAngle[VoteHead]  = GetSweepAngle();
+  VoteCounts[bin]     += weight;
+  VoteHead = (VoteHead + 1) % BEACON_VOTE_WINDOW;
+  return bin;
+}
+
+/****************************************************************************
+ Function
+     CheckForLock
+
+ Parameters
+     None
+
+ Returns
+     bool - true if a beacon was locked
+
+ Description
+     Locks the leading beacon and moves to BeaconLocked once it holds
+     BEACON_LOCK_VOTES of weight. Called after each vote while unlocked.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static bool CheckForLock(void)
+{
+  uint8_t leader = FindLeadingBeacon();
+
+  if ((leader == NO_BEACON_BIN) || (VoteCounts[leader] < BEACON_LOCK_VOTES))
+  {
+    return false;
+  }
+  LockBeacon(leader);
+  CurrentState = BeaconLocked;
+  DB_printf("SignalDetected -> BeaconLocked ('%c') with %d/%d votes\r\n",
+      LockedBeaconId, VoteCounts[leader],
+      BEACON_VOTE_WINDOW * BURST_WEIGHT_STRONG);
+  return true;
+}
+
+/****************************************************************************
+ Function
+     FindLeadingBeacon
+
+ Parameters
+     None
+
+ Returns
+     uint8_t - index into BeaconTable of the beacon with the most votes in
+               the window, NO_BEACON_BIN if no beacon has any or two tie
+
+ Description
+     A tie has no leader so that neither beacon can lock on it.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint8_t FindLeadingBeacon(void)
+{
+  uint8_t leader    = NO_BEACON_BIN;
+  uint8_t bestVotes = 0;
+  uint8_t i;
 
-    if (FirstSample)
+  for (i = 0; i < NUM_BEACONS; i++)
+  {
+    if (VoteCounts[i] > bestVotes)
     {
-      SmoothedTimeLapse = timeLapse;
-      FirstSample       = false;
+      bestVotes = VoteCounts[i];
+      leader    = i;
     }
-    else
+    else if ((VoteCounts[i] == bestVotes) && (bestVotes != 0))
     {
-      SmoothedTimeLapse = (timeLapse + 5 * SmoothedTimeLapse) / 6;
+      leader = NO_BEACON_BIN;
     }
+  }
+  return leader;
+}
+
+/****************************************************************************
+ Function
+     LockBeacon
+
+ Parameters
+     uint8_t bin - index into BeaconTable of the beacon that won the vote
+
+ Returns
+     None
+
+ Description
+     Locks onto the beacon and notifies MainLogicFSM exactly once. The
+     lock's beam entry is the angle of the beacon's oldest vote in the
+     window, its exit the newest.
 
-    frequency = CalculateFrequency(SmoothedTimeLapse);
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void LockBeacon(uint8_t bin)
+{
+  ES_Event_t BeaconEvent;
+  uint8_t    i;
+  uint8_t    slot;
+  bool       foundEntry = false;
+
+  // walk the window from the oldest vote to the newest
+  for (i = 0; i < BEACON_VOTE_WINDOW; i++)
+  {
+    slot = (VoteHead + i) % BEACON_VOTE_WINDOW;
+    if (VoteRing[slot] == bin)
+    {
+      if (!foundEntry)
+      {
+        LockEntryAngle = VoteAngle[slot];
+        foundEntry     = true;
+      }
+      LockExitAngle = VoteAngle[slot];
+    }
   }
 
-  // Advance the timing window regardless
-  LastCapturedTime = currentCapturedTime;
-  return frequency;
+  LockedBin              = bin;
+  LockedBeaconId         = BeaconTable[bin].id;
+  BeaconEvent.EventType  = ES_BEACON_DETECTED;
+  BeaconEvent.EventParam = LockedBeaconId;
+  PostMainLogicFSM(BeaconEvent);
 }
 
 /****************************************************************************
  Function
-     FindMatchingBeacon
+     EndLock
 
  Parameters
-     uint32_t frequency - frequency in Hz to look up in BeaconTable
+     None
 
  Returns
-     int8_t - index into BeaconTable of the first match within
-               BEACON_FREQ_TOLERANCE, or -1 if no beacon matches
+     None
 
  Description
-     Searches BeaconTable for a frequency within tolerance. Returns -1
-     rather than a sentinel char so that callers can cleanly distinguish
-     "no match" from any valid beacon id character.
+     Drops the current lock, recording its bearing if a sweep is active.
 
  Author
-     Tianyu, 02/19/26
+     Team, 10/17/26
 ****************************************************************************/
-static int8_t FindMatchingBeacon(uint32_t frequency)
+static void EndLock(void)
 {
-  for (uint8_t i = 0; i < NUM_BEACONS; i++)
+  RecordBearing();
+  LockedBin      = NO_BEACON_BIN;
+  LockedBeaconId = 0;
+}
+
+/****************************************************************************
+ Function
+     RecordBearing
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     During a sweep, turns the current lock's entry and exit angles into a
+     bearing for the beacon, keeping the widest pass if the beacon was
+     locked more than once, and posts ES_BEACON_BEARING to MainLogicFSM.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void RecordBearing(void)
+{
+  uint16_t   span;
+  int32_t    bearing;
+  ES_Event_t BearingEvent;
+
+  if (SweepActive && (LockedBin != NO_BEACON_BIN))
   {
-    if ((frequency >= BeaconTable[i].freq - BEACON_FREQ_TOLERANCE) &&
-        (frequency <= BeaconTable[i].freq + BEACON_FREQ_TOLERANCE))
+    // +1 so that a single vote still marks the beacon as seen
+    span = (uint16_t)(LockExitAngle - LockEntryAngle + 1);
+    if (span > BeaconSpan[LockedBin])
     {
-      return (int8_t)i;
+      bearing = ((int32_t)LockEntryAngle + LockExitAngle) / 2;
+      // The sensor looks CCW of the front, so the front faces the beacon
+      // BEACON_SENSOR_OFFSET_DEG10 CCW of where the sensor did
+      if (SweepClockwise)
+      {
+        bearing -= BEACON_SENSOR_OFFSET_DEG10;
+      }
+      else
+      {
+        bearing += BEACON_SENSOR_OFFSET_DEG10;
+      }
+      BeaconBearing[LockedBin] = (bearing < 0) ? 0 : (uint16_t)bearing;
+      BeaconSpan[LockedBin]    = span;
+      DB_printf("Beacon '%c' bearing %d.%d deg, beam %d.%d deg\r\n",
+          LockedBeaconId, BeaconBearing[LockedBin] / 10,
+          BeaconBearing[LockedBin] % 10, (span - 1) / 10, (span - 1) % 10);
     }
+    BearingEvent.EventType  = ES_BEACON_BEARING;
+    BearingEvent.EventParam = LockedBeaconId;
+    PostMainLogicFSM(BearingEvent);
   }
-  return -1;
+}
+
+/****************************************************************************
+ Function
+     GetSweepAngle
+
+ Parameters
+     None
+
+ Returns
+     uint16_t - tenths of a degree turned since the sweep started, 0 when
+                no sweep is active
+
+ Description
+     Turns the encoder IC counts of both wheels into a point turn angle
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint16_t GetSweepAngle(void)
+{
+  if (!SweepActive)
+  {
+    return 0;
+  }
+  return (uint16_t)ICCountToTurnAngle_deg10(
+      DCMotor_GetICEventCount(LEFT_MOTOR) +
+      DCMotor_GetICEventCount(RIGHT_MOTOR) - SweepStartCounts);
 }
 
 /****************************************************************************
@@ -845,7 +1493,10 @@ static int8_t FindMatchingBeacon(uint32_t frequency)
  Description
      Handles the two timeout events shared by SignalDetected and
      BeaconLocked:
-       SIGNAL_WATCHDOG_TIMER expiry  → reset history, go to NoSignal
+       SIGNAL_WATCHDOG_TIMER expiry  → if an edge kicked it within the last
+                                       SIGNAL_WATCHDOG_INTERVAL, re-arm for
+                                       the rest of that interval; otherwise
+                                       reset history, go to NoSignal
        PRINT_FREQUENCY_TIMER expiry  → debug-print frequency, restart timer
 
  Author
@@ -855,21 +1506,74 @@ static void HandleCommonTimeout(ES_Event_t ThisEvent)
 {
   if (ThisEvent.EventParam == SIGNAL_WATCHDOG_TIMER)
   {
+    uint32_t sinceKick = GetTimer3Time() - LastKickTime;
+    if (sinceKick < SIGNAL_WATCHDOG_TICKS)
+    {
+      // Edges are still arriving; wait out the window after the latest one
+      ES_Timer_InitTimer(SIGNAL_WATCHDOG_TIMER, (uint16_t)
+          (((SIGNAL_WATCHDOG_TICKS - sinceKick) / TIMER3_TICKS_PER_MS) + 1));
+      return;
+    }
+    EndLock();
     ResetSignalHistory();
-    LockedBeaconId    = 0;
-    CandidateBeaconId = 0;
-    BeaconMatchCount  = 0;
+
+    // A partial burst still in the FIFO would be over a Timer3 period old
+    // by the time the signal returns. A capture that came in while IC1IE
+    // was off has set IC1IF; clear it so the ISR does not run on the
+    // emptied FIFO
+    IEC0bits.IC1IE = 0;
+    FlushCaptureFifo();
+    IFS0CLR = _IFS0_IC1IF_MASK;
+    IEC0bits.IC1IE = 1;
+
     CurrentState      = NoSignal;
     DB_printf("-> NoSignal (watchdog expired)\r\n");
   }
 //  else if (ThisEvent.EventParam == PRINT_FREQUENCY_TIMER)
 //  {
-//    uint32_t frequency = CalculateFrequency(SmoothedTimeLapse);
+//    uint32_t frequency = CalculateFrequency(BurstLapses[0]);
 //    DB_printf("Frequency: %d Hz\r\n", frequency);
-//    DB_printf("Time lapse: %d ticks\r\n", SmoothedTimeLapse);
 //    ES_Timer_InitTimer(PRINT_FREQUENCY_TIMER, PRINT_FREQUENCY_INTERVAL);
 //  }
 }
 
+/****************************************************************************
+ Function
+     GetTimer3Time
+
+ Parameters
+     None
+
+ Returns
+     uint32_t - the current 32-bit virtual Timer3 time
+
+ Description
+     Combines SharedTimer3RolloverCounter with TMR3 for task-level code.
+     Re-reads if the Timer3 ISR counted a rollover between the two reads.
+     Leaves T3IF for the ISR, it only reads the time.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint32_t GetTimer3Time(void)
+{
+  uint16_t rollovers;
+  uint16_t timer16;
+
+  do
+  {
+    rollovers = SharedTimer3RolloverCounter;
+    timer16   = TMR3;
+  } while (rollovers != SharedTimer3RolloverCounter);
+
+  // A rollover whose ISR has not run yet (e.g. held off by a higher
+  // priority ISR) is not in the counter
+  if (IFS0bits.T3IF && (timer16 < 0x8000))
+  {
+    rollovers++;
+  }
+  return ((uint32_t)rollovers << 16) | timer16;
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
\ No newline at end of file
@@ -49,11 +49,44 @@
  When           Who     What/Why
  -------------- ---     --------
  01/28/26       Tianyu  Initial creation for Lab 7
+ 10/17/26       Team    added ICCountToTurnAngle_deg10
+ 10/17/26       Team    period conversions use ReciprocalDivide, no hardware
+                        divide
+ 10/17/26       Team    ReciprocalDivide +1 check widened before the add so
+                        quotient 0xFFFFFFFF does not wrap
+ 10/17/26       Team    added IntegerSqrt for the position loop
 ****************************************************************************/
 /*----------------------------- Include Files -----------------------------*/
 #include "CommonDefinitions.h"
+#include "ES_LookupTables.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// ReciprocalDivide table: 2^RECIP_INDEX_BITS segments over [1, 2)
+#define RECIP_INDEX_BITS  6u
+#define RECIP_FRAC_BITS   16u   // interpolation weight resolution
 
 /*---------------------------- Module Variables ---------------------------*/
+// 2^31 / (1 + i/64) for i = 0..64, rounded. The extra entry at the end lets
+// the last segment interpolate without a special case.
+static const uint32_t RecipTable[(1u << RECIP_INDEX_BITS) + 1u] = {
+  2147483648u, 2114445438u, 2082408386u, 2051327664u,
+  2021161080u, 1991868891u, 1963413621u, 1935759908u,
+  1908874354u, 1882725390u, 1857283155u, 1832519380u,
+  1808407283u, 1784921474u, 1762037865u, 1739733588u,
+  1717986918u, 1696777203u, 1676084798u, 1655891006u,
+  1636178018u, 1616928864u, 1598127366u, 1579758086u,
+  1561806289u, 1544257904u, 1527099483u, 1510318170u,
+  1493901668u, 1477838209u, 1462116526u, 1446725826u,
+  1431655765u, 1416896428u, 1402438301u, 1388272257u,
+  1374389535u, 1360781718u, 1347440720u, 1334358772u,
+  1321528399u, 1308942414u, 1296593901u, 1284476201u,
+  1272582903u, 1260907830u, 1249445032u, 1238188770u,
+  1227133513u, 1216273925u, 1205604855u, 1195121335u,
+  1184818564u, 1174691910u, 1164736894u, 1154949189u,
+  1145324612u, 1135859120u, 1126548799u, 1117389866u,
+  1108378657u, 1099511628u, 1090785345u, 1082196484u,
+  1073741824u
+};
 
 // Shared Timer3 rollover counter used by BeaconDetectFSM (IC1),
 // DCMotorService IC3 (left encoder) and IC2 (right encoder).
@@ -98,6 +131,124 @@ const uint8_t validCommandBytes[21] = {
 
 /*------------------------------ Module Code ------------------------------*/
 
+/****************************************************************************
+ Function
+     ReciprocalDivide
+
+ Parameters
+     uint32_t num - dividend
+     uint32_t den - divisor
+
+ Returns
+     uint32_t - num / den rounded down, the same as the C operator;
+                0 if den is 0
+
+ Description
+     Division without the hardware divider, for the period conversions
+     that run on every sample in ISRs and the control loop. The PIC32MX
+     divider takes up to 35 cycles and the float path is software; this
+     takes a fixed number of single-cycle multiplies whatever the operands.
+
+     den is normalised to a mantissa m in [1, 2) (CLZ), 1/m is read from
+     RecipTable with linear interpolation (good to ~6e-5), one Newton step
+     r' = r * (2 - m * r) takes it to ~4e-9, and the quotient is then
+     corrected by one. The correction checks are done in 64 bits, so the
+     result is exact over the whole uint32_t range, including
+     0xFFFFFFFF / 1.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t ReciprocalDivide(uint32_t num, uint32_t den)
+{
+  uint8_t  msb;
+  uint32_t mant;      // den << (31 - msb), m in Q31
+  uint32_t index;
+  uint32_t frac;
+  uint32_t recip;     // 1/m in Q31
+  int32_t  error;     // 1 - m * recip, Q31
+  uint32_t quotient;
+
+  if (den == 0u)
+  {
+    return 0u;
+  }
+  msb   = ES_GetMSBitSet(den);
+  mant  = den << (31u - msb);
+  index = (mant >> (31u - RECIP_INDEX_BITS)) & ((1u << RECIP_INDEX_BITS) - 1u);
+  frac  = (mant >> (31u - RECIP_INDEX_BITS - RECIP_FRAC_BITS)) &
+          ((1u << RECIP_FRAC_BITS) - 1u);
+
+  // linear interpolation between the two table entries
+  recip = RecipTable[index] - (uint32_t)(((uint64_t)(RecipTable[index] -
+          RecipTable[index + 1u]) * frac) >> RECIP_FRAC_BITS);
+
+  // one Newton step; m * recip is within 1e-4 of 1.0 (2^62 in Q62)
+  error = (int32_t)((int64_t)((1ULL << 62) - (uint64_t)mant * recip) >> 31);
+  recip += (uint32_t)(((int64_t)recip * error) >> 31);
+
+  // num / den = num * recip / 2^(31 + msb)
+  quotient = (uint32_t)(((uint64_t)num * recip) >> (31u + msb));
+
+  // recip is within a few LSBs, so the quotient is at most one out
+  if ((uint64_t)quotient * den > num)
+  {
+    quotient--;
+  }
+  else if (((uint64_t)quotient + 1u) * den <= num)
+  {
+    quotient++;
+  }
+  return quotient;
+}
+
+/****************************************************************************
+ Function
+     IntegerSqrt
+
+ Parameters
+     uint32_t value - number to take the root of
+
+ Returns
+     uint32_t - the square root of value rounded down
+
+ Description
+     Square root for the control ISR without sqrtf. Works out the root one
+     bit at a time from the top (the digit-by-digit method in base 4), so
+     it is only shifts, adds and compares: at most 16 passes, fewer for
+     small values since it starts at the highest set bit.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t IntegerSqrt(uint32_t value)
+{
+  uint32_t root = 0u;
+  uint32_t bit;   // current result bit, squared
+
+  if (value == 0u)
+  {
+    return 0u;
+  }
+  // highest power of four not above value
+  bit = 1u << (ES_GetMSBitSet(value) & ~1u);
+
+  while (bit != 0u)
+  {
+    if (value >= (root + bit))
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
 /****************************************************************************
  Function
      PeriodToSpeed_mm_s
@@ -107,7 +258,8 @@ const uint8_t validCommandBytes[21] = {
                              for one wheel (from DCMotor_GetEncoderPeriod)
 
  Returns
-     uint32_t - wheel surface speed in mm/s, 0 if period_ticks is 0
+     uint32_t - wheel surface speed in mm/s, 0 if period_ticks is 0 or so
+                long that the wheel is effectively stopped
 
  Description
      Converts raw IC period ticks to mm/s using integer arithmetic only.
@@ -121,11 +273,37 @@ const uint8_t validCommandBytes[21] = {
 ****************************************************************************/
 uint32_t PeriodToSpeed_mm_s(uint32_t period_ticks)
 {
-  if (period_ticks == 0u)
+  // DCMotorService passes 0xFFFFFFFF before the first capture; don't let
+  // the denominator wrap
+  if ((period_ticks == 0u) ||
+      (period_ticks > (0xFFFFFFFFu / (uint32_t)SPEED_CONV_DEN)))
   {
     return 0u;
   }
-  return (uint32_t)(SPEED_CONV_NUM / ((uint32_t)SPEED_CONV_DEN * period_ticks));
+  return ReciprocalDivide((uint32_t)SPEED_CONV_NUM,
+                          (uint32_t)SPEED_CONV_DEN * period_ticks);
+}
+
+/****************************************************************************
+ Function
+     PeriodToFrequency_Hz
+
+ Parameters
+     uint32_t period_ticks - Timer3 ticks between IC captures, where each
+                             capture is IC_PRESCALE signal edges
+
+ Returns
+     uint32_t - signal frequency in Hz, 0 if period_ticks is 0
+
+ Description
+     frequency = (TIMER3_CLOCK_HZ * IC_PRESCALE) / period_ticks
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t PeriodToFrequency_Hz(uint32_t period_ticks)
+{
+  return ReciprocalDivide(TIMER3_CLOCK_HZ * IC_PRESCALE, period_ticks);
 }
 
 /****************************************************************************
@@ -153,5 +331,33 @@ uint32_t ICCountToDistance_mm(uint32_t ic_event_count)
   return (ic_event_count * (uint32_t)DIST_CONV_NUM) / (uint32_t)DIST_CONV_DEN;
 }
 
+/****************************************************************************
+ Function
+     ICCountToTurnAngle_deg10
+
+ Parameters
+     uint32_t ic_event_sum - IC events of the left plus the right wheel
+                             counted during a point turn
+
+ Returns
+     uint32_t - heading change in tenths of a degree
+
+ Description
+     In a point turn each wheel travels the arc ROTATE_ARC_MM(angle), so
+     the mean wheel distance gives the angle:
+     angle_deg10 = (sum * DIST_CONV_NUM / DIST_CONV_DEN / 2) * 3600
+                   / TURN_CIRC_MM
+     Uses the same distance conversion as ICCountToDistance_mm so it agrees
+     with the odometer-based rotations in NavigationFSM.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t ICCountToTurnAngle_deg10(uint32_t ic_event_sum)
+{
+  return (uint32_t)(((uint64_t)ic_event_sum * (DIST_CONV_NUM) * 3600u) /
+                    (2u * (uint64_t)DIST_CONV_DEN * TURN_CIRC_MM));
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
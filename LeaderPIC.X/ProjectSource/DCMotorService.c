@@ -17,9 +17,46 @@
     - PI speed control loops running at 2ms intervals (Timer4)
     - Motor direction control
 
+    Arithmetic in the control ISR: the position loop, the speed estimator
+    and the period to speed conversion are integer. UpdateSetpointRamp,
+    FeedforwardDuty and the PI loops are still float, which the PIC32MX170
+    does in software (no FPU), for both wheels every period. The integer
+    parts hand over to them through the float TargetSpeed_mm_s and
+    CurrentMeasuredSpeed.
+
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    position mode: encoder-count position loop over the
+                        speed loops, DCMotor_MoveDistance_mm
+ 10/17/26       Team    DCMotor_EmergencyOff, registered as the stack
+                        monitor's safe-state handler
+ 10/17/26       Team    ISR profiling brackets on IC2, IC3, Timer3 and the
+                        control ISR
+ 10/17/26       Team    fixed-point steady-state Kalman speed/position
+                        estimator feeding the PI loops
+ 10/17/26       Team    battery-compensated speed-to-duty feedforward
+                        under the PI loops
+ 10/17/26       Team    accel/decel/jerk limited setpoint ramps in the
+                        control ISR
+ 10/17/26       Team    stall and wheel-slip detection, posts to MainLogicFSM
+                        and can cut the drive
+ 10/17/26       Team    PeriodToRPM in integer arithmetic, no divide
+ 10/17/26       Team    control ISR raises a bottom half instead of posting
+ 10/17/26       Team    declare ES_MOTOR_ACTION_CHANGE deadline for EDF
+ 10/17/26       Team    battery sense moved to AN3 (RB1), RB14 is SCK1
+ 10/17/26       Team    safe state handler registered from main
+ 10/17/26       Team    position loop in integer arithmetic, no sqrtf
+ 10/17/26       Team    battery sampled every BATT_SAMPLE_INTERVAL_MS of
+                        framework time, not every 25th bottom half
+ 10/17/26       Team    estimator subtracts the battery-scaled deadband
+ 10/17/26       Team    notes list which control ISR parts are still float
+ 10/17/26       Team    stops ramp down by default, DCMotor_StopNow skips
+                        the ramp
+ 10/17/26       Team    battery sense only with BATTERY_SENSE, feedforward
+                        off until its constants are measured
+ 10/17/26       Team    position loop clamps its speed in 64 bits before
+                        narrowing it
  02/25/26       Tianyu  Integrated encoder and speed control into DCMotorService
  01/21/26       Tianyu  Updated for Lab 6 motor speed control
  01/15/26       Tianyu  Fixed position wrapping logic for unsigned type
@@ -30,6 +67,8 @@
 #include "ES_Framework.h"
 #include "ES_Timers.h"
 #include "DCMotorService.h"
+#include "MainLogicFSM.h"
+#include "NavigationFSM.h"
 #include "CommonDefinitions.h"
 #include "Ports.h"
 #include "PIC32_AD_Lib.h"
@@ -84,10 +123,116 @@
 #define TS 0.002f                    // Sampling time in seconds (2 ms)
 #define INTEGRAL_CLAMP_TICKS  (DUTY_MAX_TICKS * 2 / 3)
 
+// Feedforward: the duty a wheel needs to hold a speed on a battery at
+// BATT_NOMINAL_MV is about FF_DEADBAND_TICKS + FF_GAIN_TICKS_PER_MM_S * speed.
+// It is scaled by BATT_NOMINAL_MV / battery voltage and added to the PI
+// output, leaving the integrator only the residual. Measure the two
+// constants by stepping MotorCommandWrapper duties open loop; err on the
+// low side, the PI loop makes up a shortfall faster than it sheds excess.
+// The values below are estimates, not measurements, so the feedforward
+// stays off until they have been measured.
+#define USE_FEEDFORWARD         false
+#define FF_DEADBAND_TICKS       200.0f
+#define FF_GAIN_TICKS_PER_MM_S  2.1f
+
+// Battery sense (BATTERY_SENSE in CommonDefinitions.h) on AN3 (RB1, pin 5)
+// through a 30k / 10k divider, 10-bit ADC against 3.3 V:
+// mV = counts * 3300 * 4 / 1024. Without it the feedforward assumes
+// BATT_NOMINAL_MV.
+#define BATT_PIN_TRIS           TRISBbits.TRISB1
+#define BATT_PIN_ANSEL          ANSELBbits.ANSB1
+#define BATT_MV_PER_COUNT_NUM   (3300u * 4u)
+#define BATT_MV_PER_COUNT_SHIFT 10u
+#define BATT_NOMINAL_MV         9000u   // voltage the FF constants were set at
+// readings outside this range (divider unplugged, ADC not yet set up) are
+// ignored and the last good value kept
+#define BATT_MIN_VALID_MV       6000u
+#define BATT_MAX_VALID_MV       13000u
+#define BATT_SAMPLE_INTERVAL_MS 50u
+#define BATT_FILTER_SHIFT       3u      // new reading weighted 1/8
+
+// Speed estimator. When true the PI loops use a per-wheel Kalman estimate
+// of position, speed and a disturbance acceleration instead of the EMA of
+// the raw period speed. Model: the wheel's speed approaches the feedforward
+// steady-state speed for the applied duty with time constant EST_TAU_S
+// (EST_MODEL_Q32 = TS / EST_TAU_S), plus the disturbance. Measurements are
+// the IC count (extrapolated from the last capture time) and the period
+// speed. The gains are the steady-state Kalman gains for that model with
+// sigma 0.7 mm on position, 25 mm/s on speed, 200 mm/s^2 model error and a
+// 10000 mm/s^2/sqrt(s) disturbance walk, Q16, rows p v d, columns p v.
+// Recompute them if TS, EST_TAU_S or the noise levels change.
+#define USE_SPEED_ESTIMATOR   true
+#define EST_TAU_S             0.08f
+#define EST_MODEL_Q32         107374182   // 0.002 / 0.08 * 2^32
+#define EST_TS_Q32            8589935     // 0.002 * 2^32
+#define EST_TICK_S_Q32        54976       // 2^32 / TIMER3_CLOCK_HZ
+#define EST_MAX_ELAPSED_TICKS 65535u      // caps the extrapolation product
+#define EST_K_PP   4288
+#define EST_K_PV   90
+#define EST_K_VP   114862
+#define EST_K_VV   13860
+#define EST_K_DP   2319337
+#define EST_K_DV   1034205
+// um travelled per IC event, Q16
+#define EST_STEP_UM_Q16 \
+    ((uint32_t)(((uint64_t)DIST_CONV_NUM * 1000u * 65536u) / DIST_CONV_DEN))
+
 // Smoothing factor: 0.0 = no update (frozen), 1.0 = no filtering (raw)
 // 0.3 means each new reading contributes 30% of the new value
 #define MEAS_SPEED_ALPHA  0.4f
 
+// Setpoint ramps. The control ISR moves each wheel's signed velocity
+// setpoint towards the commanded one at no more than RAMP_ACCEL_MM_S2 when
+// speeding up and RAMP_DECEL_MM_S2 when slowing down, changing the
+// acceleration by at most RAMP_JERK_MM_S3 (0 = no jerk limit). Reversals
+// ramp down through zero before the direction pins change. A command of 0
+// ramps down like any other; DCMotor_StopNow drops the setpoints at once.
+#define RAMP_ACCEL_MM_S2      1500.0f
+#define RAMP_DECEL_MM_S2      3000.0f
+#define RAMP_JERK_MM_S3       30000.0f
+
+// Position mode (DCMotor_MoveDistance_mm). Each control period an outer
+// loop turns a wheel's remaining distance, counted in IC events, into a
+// speed command for the ramps and PI loop above: POS_KP_PER_S times the
+// remaining distance, at most the move's max speed or what can still stop
+// at POS_DECEL_MM_S2 (below RAMP_DECEL_MM_S2 so the ramp keeps up), and
+// at least POS_MIN_SPEED_MM_S so the last few mm are not left to the
+// integrator. A wheel has arrived within half an IC event of its target,
+// and only moves again if pushed POS_RESUME_UM off. The move is done when
+// both have arrived and stayed under POS_SETTLE_SPEED_MM_S for
+// POS_SETTLE_PERIODS. The loop itself is integer: distances in um, speeds
+// in whole mm/s and IntegerSqrt for the stopping speed. The _Q16 constants
+// fold the um to mm scaling into the gains. Only its output to the float
+// ramp setpoint and the settle check against the measured speed touch
+// float, since the ramps and PI loop are float (see Notes).
+#define POS_KP_PER_S          4u
+#define POS_DECEL_MM_S2       2000u
+#define POS_MIN_SPEED_MM_S    30u
+#define POS_KP_Q16            ((POS_KP_PER_S * 65536u + 500u) / 1000u)
+#define POS_STOP_V2_Q16       ((2u * POS_DECEL_MM_S2 * 65536u + 500u) / 1000u)
+#define POS_TOLERANCE_UM      ((int32_t)(EST_STEP_UM_Q16 >> 17))
+#define POS_RESUME_UM         (3 * POS_TOLERANCE_UM)
+#define POS_SETTLE_SPEED_MM_S 10.0f
+#define POS_SETTLE_PERIODS    25u   // 50 ms
+
+// Stall and slip detection, checked every control period.
+// A wheel is stalled when its duty is near full but it turns at under a
+// quarter of its target for STALL_CONFIRM_PERIODS in a row. Checking
+// starts STALL_SPINUP_PERIODS after the wheel is started or reversed so
+// that normal acceleration is not mistaken for a stall.
+#define STALL_DUTY_TICKS      (DUTY_MAX_TICKS * 9 / 10)
+#define STALL_SPEED_DIVISOR   4
+#define STALL_CONFIRM_PERIODS 40    // 80 ms
+#define STALL_SPINUP_PERIODS  150   // 300 ms
+// On a straight move (same speed and direction both sides) the wheels'
+// IC counts may differ by SLIP_MIN_EVENTS (~21 mm) plus 1/8 of the mean
+// distance before it counts as slip
+#define SLIP_MIN_EVENTS       10
+#define SLIP_TRAVEL_SHIFT     4     // (left + right) / 16 = mean / 8
+// When true a stall zeroes both duties until the next different speed
+// command, e.g. Nav_Stop, so a pinned robot does not keep pushing
+#define STALL_CUTS_DRIVE      true
+
 // RPM calculation constants
 #define INVALID_TIME 0xFFFFFFFF      // Marker for invalid/uninitialized time
 
@@ -102,12 +247,22 @@ static uint16_t MapSpeedToDutyCycle(uint16_t desiredSpeed);
 // Encoder functions
 static void ConfigureEncoderTimer(void);
 static void ConfigureInputCapture(void);
-static float PeriodToRPM(uint32_t period);  // Local float version for PI controller only
+static uint32_t PeriodToRPM(uint32_t period);  // Local version for PI controller only
 uint32_t GetElapsedTicksSinceLastEdge(uint8_t motorIndex);
 
 // Speed control functions
 static void ConfigureControlTimer(void);
 static int16_t ClampDutyCycle(float value);
+static void MotorControlBottomHalf(void);
+static void CheckDriveFaults(void);
+static void UpdateSetpointRamp(uint8_t motorIndex);
+static void UpdatePositionLoop(void);
+static void RestartDriveSupervision(bool straightMove);
+static float FeedforwardDuty(float targetSpeed);
+#if BATTERY_SENSE
+static void UpdateBatteryVoltage(void);
+#endif
+static float UpdateSpeedEstimate(uint8_t motorIndex, uint32_t measured_mm_s);
 
 /*---------------------------- Module Variables ---------------------------*/
 // Module level Priority variable
@@ -116,7 +271,32 @@ static uint8_t MyPriority;
 // Motor control variables
 static float TargetSpeed_mm_s[2];     // Target speed in mm/s (set by DCMotor_SetSpeed_mm_s, read by PI controller)
 static uint16_t DesiredSpeed[2];      // Duty cycle ticks (output from PI controller)
-static uint8_t DesiredDirection[2];
+static uint8_t DesiredDirection[2];   // direction applied to the pins
+static uint8_t CommandedDirection[2]; // direction asked for by the caller
+
+// Setpoint ramps (updated by the control ISR), signed mm/s, + = FORWARD
+static float RampVelocity[2] = {0.0f, 0.0f};
+static float RampAccel[2] = {0.0f, 0.0f};  // mm/s per control period
+// limits per control period, set by DCMotor_SetRampLimits
+static float RampAccelStep = RAMP_ACCEL_MM_S2 * TS;
+static float RampDecelStep = RAMP_DECEL_MM_S2 * TS;
+static float RampJerkStep  = RAMP_JERK_MM_S3 * TS * TS;
+// set by DCMotor_StopNow, the ISR skips the ramp while the target is 0
+static volatile bool RampBypass = false;
+
+// Position mode. While PositionMode is set the control ISR owns
+// TargetSpeed_mm_s and CommandedDirection. Travel is in IC events, signed
+// by the direction driven since the encoders cannot see direction.
+static volatile bool PositionMode = false;
+static int32_t  PosTarget_um[2] = {0, 0};
+static int32_t  PosTravel[2] = {0, 0};
+static uint32_t PosLastCount[2] = {0u, 0u};
+static uint8_t  PosDirection[2] = {FORWARD, FORWARD};
+static bool     PosArrived[2] = {false, false};
+static uint16_t PosMaxSpeed = 0;      // mm/s
+static uint16_t PosSettlePeriods = 0;
+// set by the ISR, posted to NavigationFSM by MotorControlBottomHalf
+static volatile uint32_t PendingMoveDone = 0;
 
 // Encoder variables (for left and right wheels)
 static volatile uint32_t CapturedTime[2] = {0, 0};          // Latest captured time for each wheel
@@ -138,6 +318,41 @@ static volatile float CurrentMeasuredSpeed[2] = {0.0f, 0.0f};
 static float FilteredSpeed[2] = {0.0f, 0.0f};
 static volatile int16_t CurrentDutyCycleTicks[2] = {0, 0};
 
+// Stall and slip detection (updated by the control ISR)
+static uint16_t StallPeriods[2] = {0, 0};  // consecutive stalled periods
+static uint16_t SpinUpPeriods[2] = {0, 0}; // periods before checking starts
+static volatile bool SlipCheckActive = false; // a straight move is under way
+static uint32_t SlipLastCount[2] = {0u, 0u};
+static int32_t  SlipDivergence = 0;        // left - right IC events
+static uint32_t SlipTravel = 0;            // left + right IC events
+static volatile uint8_t FaultsReported = 0;  // posted already for this command
+static volatile bool DriveCut = false;     // a stall has cut the drive
+// set by the ISR, posted to MainLogicFSM by MotorControlBottomHalf
+static volatile uint32_t PendingFaults = 0;
+
+// Battery compensation: filtered battery voltage, and the feedforward
+// scale BATT_NOMINAL_MV / battery written at task level for the ISR
+static uint16_t BatteryVoltage_mV = BATT_NOMINAL_MV;
+static volatile float FeedforwardScale = 1.0f;
+#if BATTERY_SENSE
+static uint16_t LastBatterySampleTime = 0;  // ES_Timer_GetTime() of the last read
+#endif
+
+// Speed estimator state (control ISR only), um, um/s and um/s^2, position
+// measured from the last DCMotor_ResetICEventCount
+static int32_t  EstPosition_um[2] = {0, 0};
+static int32_t  EstVelocity_um_s[2] = {0, 0};
+static int32_t  EstDisturbance_um_s2[2] = {0, 0};
+static uint32_t EstLastCount[2] = {0u, 0u};
+// Inverse of the feedforward for the estimator: steady-state um/s per duty
+// tick above the deadband, Q16, and the deadband in duty ticks. Both follow
+// the battery like FeedforwardScale, so
+// v = (duty - DeadbandTicks) * DutyToSpeedQ16
+//   = (duty - FF_DEADBAND_TICKS * scale) / (FF_GAIN_TICKS_PER_MM_S * scale)
+static volatile int32_t DutyToSpeedQ16 =
+    (int32_t)(1000.0f * 65536.0f / FF_GAIN_TICKS_PER_MM_S);
+static volatile int32_t DeadbandTicks = (int32_t)FF_DEADBAND_TICKS;
+
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
  Function
@@ -161,6 +376,8 @@ bool InitDCMotorService(uint8_t Priority)
   ES_Event_t ThisEvent;
 
   MyPriority = Priority;
+  // PWM updates from the control ISR must go out within one control period
+  ES_SetDeadline(MyPriority, ES_MOTOR_ACTION_CHANGE, 2);
   
   // Initialize motor control variables
   TargetSpeed_mm_s[LEFT_MOTOR] = 0.0f;
@@ -169,6 +386,8 @@ bool InitDCMotorService(uint8_t Priority)
   DesiredSpeed[RIGHT_MOTOR] = 0;
   DesiredDirection[LEFT_MOTOR] = FORWARD;
   DesiredDirection[RIGHT_MOTOR] = FORWARD;
+  CommandedDirection[LEFT_MOTOR] = FORWARD;
+  CommandedDirection[RIGHT_MOTOR] = FORWARD;
   
   // Initialize encoder variables
   CapturedTime[LEFT_MOTOR] = 0;
@@ -197,6 +416,12 @@ bool InitDCMotorService(uint8_t Priority)
   
   // Configure motor control pins and PWM
   ConfigureDCMotorPins();
+
+#if BATTERY_SENSE
+  // Battery sense input, converted in NavigationFSM's ADC scan set
+  BATT_PIN_TRIS = 1;
+  BATT_PIN_ANSEL = 1;
+#endif
   ConfigurePWM();
   
   // Configure encoder Input Capture pins as digital inputs
@@ -210,6 +435,9 @@ bool InitDCMotorService(uint8_t Priority)
   ConfigureEncoderTimer();
   ConfigureInputCapture();
   
+  // The control ISR hands PWM updates to us through a bottom half
+  _HW_RegisterBottomHalf(BH_MOTOR_CONTROL, MotorControlBottomHalf);
+
   // Configure the speed control timer (Timer4)
   ConfigureControlTimer();
   
@@ -407,14 +635,43 @@ void DCMotor_SetSpeed_mm_s(uint16_t speedLeft_mm_s,
                            uint8_t  dirLeft,
                            uint8_t  dirRight)
 {
-  // Store mm/s targets for the PI controller
+  // a speed command ends any position move before the targets change
+  PositionMode = false;
+  RampBypass   = false;
+
+  bool sameCommand = (TargetSpeed_mm_s[LEFT_MOTOR]  == (float)speedLeft_mm_s) &&
+                     (TargetSpeed_mm_s[RIGHT_MOTOR] == (float)speedRight_mm_s) &&
+                     (CommandedDirection[LEFT_MOTOR]  == dirLeft) &&
+                     (CommandedDirection[RIGHT_MOTOR] == dirRight);
+
+  // Line following repeats commands every few ms, so stall and slip
+  // supervision only restarts when the command actually changes
+  if (!sameCommand)
+  {
+    // A wheel starting from rest or reversing gets time to spin up
+    if ((TargetSpeed_mm_s[LEFT_MOTOR] == 0.0f) ||
+        (CommandedDirection[LEFT_MOTOR] != dirLeft))
+    {
+      SpinUpPeriods[LEFT_MOTOR] = STALL_SPINUP_PERIODS;
+    }
+    if ((TargetSpeed_mm_s[RIGHT_MOTOR] == 0.0f) ||
+        (CommandedDirection[RIGHT_MOTOR] != dirRight))
+    {
+      SpinUpPeriods[RIGHT_MOTOR] = STALL_SPINUP_PERIODS;
+    }
+    RestartDriveSupervision((dirLeft == dirRight) &&
+                            (speedLeft_mm_s == speedRight_mm_s) &&
+                            (speedLeft_mm_s > 0u));
+  }
+
+  // Store mm/s targets; the control ISR ramps the PI setpoints to them
+  // and sets DesiredDirection as the ramps pass through zero.
+  // FilteredSpeed is no longer reset here: the setpoint now changes
+  // smoothly, and zeroing the measurement would put a step back in.
   TargetSpeed_mm_s[LEFT_MOTOR]  = (float)speedLeft_mm_s;
   TargetSpeed_mm_s[RIGHT_MOTOR] = (float)speedRight_mm_s;
-  DesiredDirection[LEFT_MOTOR]  = dirLeft;
-  DesiredDirection[RIGHT_MOTOR] = dirRight;
-  // Reset the filter when a new speed command is issued to avoid old speed affecting the new command
-  FilteredSpeed[LEFT_MOTOR] = 0.0f;
-  FilteredSpeed[RIGHT_MOTOR] = 0.0f;
+  CommandedDirection[LEFT_MOTOR]  = dirLeft;
+  CommandedDirection[RIGHT_MOTOR] = dirRight;
 
   // Debug print: target speeds and directions
   DB_printf("SetSpeed_mm_s called with Left: %u mm/s, Right: %u mm/s, DirLeft: %u, DirRight: %u\r\n",
@@ -433,6 +690,193 @@ void DCMotor_SetSpeed_mm_s(uint16_t speedLeft_mm_s,
 #endif
 }
 
+/****************************************************************************
+ Function
+     DCMotor_MoveDistance_mm
+
+ Parameters
+     uint16_t distLeft_mm   - distance for the left wheel to travel
+     uint16_t distRight_mm  - distance for the right wheel to travel
+     uint8_t  dirLeft       - FORWARD or REVERSE
+     uint8_t  dirRight      - FORWARD or REVERSE
+     uint16_t maxSpeed_mm_s - cruise speed for the longer parts of the move
+
+ Returns
+     None
+
+ Description
+     Starts a move in position mode: the control ISR drives each wheel to
+     its distance with the position loop (UpdatePositionLoop) and slows it
+     in to a stop on the target, rather than the caller polling the count
+     and cutting the speed. ES_MOVE_SETTLED is posted to NavigationFSM once
+     both wheels have settled. Distances use the same conversion as
+     ICCountToDistance_mm. Any DCMotor_SetSpeed_mm_s call ends the move.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void DCMotor_MoveDistance_mm(uint16_t distLeft_mm, uint16_t distRight_mm,
+                             uint8_t dirLeft, uint8_t dirRight,
+                             uint16_t maxSpeed_mm_s)
+{
+  uint8_t i;
+
+  // the ISR leaves the targets alone until the move is set up
+  PositionMode = false;
+  RampBypass   = false;
+
+  PosTarget_um[LEFT_MOTOR]  = (int32_t)distLeft_mm * 1000;
+  PosTarget_um[RIGHT_MOTOR] = (int32_t)distRight_mm * 1000;
+  PosDirection[LEFT_MOTOR]  = dirLeft;
+  PosDirection[RIGHT_MOTOR] = dirRight;
+  for (i = 0; i < 2; i++)
+  {
+    PosTravel[i]    = 0;
+    PosLastCount[i] = ICEventCount[i];
+    PosArrived[i]   = false;
+    SpinUpPeriods[i] = STALL_SPINUP_PERIODS;
+  }
+  PosMaxSpeed      = maxSpeed_mm_s;
+  PosSettlePeriods = 0;
+  PendingMoveDone  = 0;
+
+  RestartDriveSupervision((dirLeft == dirRight) &&
+                          (distLeft_mm == distRight_mm) &&
+                          (distLeft_mm > 0u));
+
+  DB_printf("MoveDistance called with Left: %u mm, Right: %u mm, DirLeft: %u, DirRight: %u, max %u mm/s\r\n",
+            distLeft_mm, distRight_mm, dirLeft, dirRight, maxSpeed_mm_s);
+
+  PositionMode = true;
+}
+
+/****************************************************************************
+ Function
+     DCMotor_StopNow
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Emergency stop: commands 0 on both wheels and has the control ISR drop
+     the setpoints to 0 without ramping them down. Ordinary stops go
+     through DCMotor_SetSpeed_mm_s and ramp at the decel limit. The next
+     speed command or move ramps normally again.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void DCMotor_StopNow(void)
+{
+  DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+  RampBypass = true;
+}
+
+/****************************************************************************
+ Function
+     DCMotor_SetRampLimits
+
+ Parameters
+     uint16_t accel_mm_s2 - max rate of speeding up, 0 = no limit
+     uint16_t decel_mm_s2 - max rate of slowing down, 0 = no limit
+     uint16_t jerk_mm_s3  - max rate of change of acceleration, 0 = none
+
+ Returns
+     None
+
+ Description
+     Changes the setpoint ramp limits from the RAMP_* defaults, for both
+     wheels, e.g. gentler ramps while carrying balls.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void DCMotor_SetRampLimits(uint16_t accel_mm_s2, uint16_t decel_mm_s2,
+                           uint16_t jerk_mm_s3)
+{
+  // a very large step is the same as no limit
+  RampAccelStep = (accel_mm_s2 > 0u) ? (accel_mm_s2 * TS) : 1.0e6f;
+  RampDecelStep = (decel_mm_s2 > 0u) ? (decel_mm_s2 * TS) : 1.0e6f;
+  RampJerkStep  = jerk_mm_s3 * TS * TS;
+}
+
+/****************************************************************************
+ Function
+     DCMotor_GetBatteryVoltage_mV
+
+ Parameters
+     None
+
+ Returns
+     uint16_t - filtered battery voltage in mV, BATT_NOMINAL_MV until the
+                first valid reading or without BATTERY_SENSE
+
+ Description
+     The voltage the feedforward is currently compensating for.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint16_t DCMotor_GetBatteryVoltage_mV(void)
+{
+  return BatteryVoltage_mV;
+}
+
+/****************************************************************************
+ Function
+     DCMotor_GetEstimatedSpeed_mm_s
+
+ Parameters
+     uint8_t motorIndex - LEFT_MOTOR (0) or RIGHT_MOTOR (1)
+
+ Returns
+     uint32_t - estimator's wheel speed in mm/s (magnitude)
+
+ Description
+     The speed the PI loop is working from when USE_SPEED_ESTIMATOR is set.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t DCMotor_GetEstimatedSpeed_mm_s(uint8_t motorIndex)
+{
+  if (motorIndex < 2u)
+  {
+    return (uint32_t)EstVelocity_um_s[motorIndex] / 1000u;
+  }
+  return 0u;
+}
+
+/****************************************************************************
+ Function
+     DCMotor_GetEstimatedDistance_mm
+
+ Parameters
+     uint8_t motorIndex - LEFT_MOTOR (0) or RIGHT_MOTOR (1)
+
+ Returns
+     uint32_t - estimated wheel travel in mm since the last
+                DCMotor_ResetICEventCount
+
+ Description
+     Like ICCountToDistance_mm(DCMotor_GetICEventCount()) but interpolated
+     between encoder edges, so it resolves better than one IC event.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+uint32_t DCMotor_GetEstimatedDistance_mm(uint8_t motorIndex)
+{
+  if ((motorIndex < 2u) && (EstPosition_um[motorIndex] > 0))
+  {
+    return (uint32_t)EstPosition_um[motorIndex] / 1000u;
+  }
+  return 0u;
+}
+
 /****************************************************************************
  Function
      DCMotor_GetEncoderPeriod
@@ -511,6 +955,39 @@ void DCMotor_ResetICEventCount(uint8_t motorIndex)
   }
 }
 
+/****************************************************************************
+ Function
+     DCMotor_EmergencyOff
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Forces both drives off at the pins: disables OC1/OC2, unmaps them from
+     RB4/RB5 and drives all four bridge inputs low. Touches only hardware
+     registers, so it is safe to call with interrupts off and a suspect
+     stack, or before InitDCMotorService has run; main() registers it as
+     the stack monitor's safe-state handler. Re-running InitDCMotorService
+     is the only way back.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void DCMotor_EmergencyOff(void)
+{
+  OC1CONbits.ON = 0;
+  OC2CONbits.ON = 0;
+  RPB4R = 0;
+  RPB5R = 0;
+  MOTOR_FORWARD_PIN_L = 0;
+  MOTOR_REVERSE_PIN_L = 0;
+  MOTOR_FORWARD_PIN_R = 0;
+  MOTOR_REVERSE_PIN_R = 0;
+}
+
 /***************************************************************************
  Interrupt Service Routines
  ****************************************************************************/
@@ -534,6 +1011,8 @@ void DCMotor_ResetICEventCount(uint8_t motorIndex)
 ****************************************************************************/
 void __ISR(_INPUT_CAPTURE_3_VECTOR, IPL7SOFT) InputCaptureISR_IC3(void)
 {
+  ES_ISR_ENTER(ISR_PROF_IC3);
+
   // Increment IC event counter for distance tracking
   ICEventCount[LEFT_MOTOR]++;
   
@@ -571,6 +1050,8 @@ void __ISR(_INPUT_CAPTURE_3_VECTOR, IPL7SOFT) InputCaptureISR_IC3(void)
   
   // Store current capture as last capture for next calculation
   LastCapturedTime[LEFT_MOTOR] = CapturedTime[LEFT_MOTOR];
+
+  ES_ISR_EXIT(ISR_PROF_IC3);
 }
 
 /****************************************************************************
@@ -592,6 +1073,8 @@ void __ISR(_INPUT_CAPTURE_3_VECTOR, IPL7SOFT) InputCaptureISR_IC3(void)
 ****************************************************************************/
 void __ISR(_INPUT_CAPTURE_2_VECTOR, IPL7SOFT) InputCaptureISR_IC2(void)
 {
+  ES_ISR_ENTER(ISR_PROF_IC2);
+
   // Increment IC event counter for distance tracking
   ICEventCount[RIGHT_MOTOR]++;
   
@@ -629,6 +1112,8 @@ void __ISR(_INPUT_CAPTURE_2_VECTOR, IPL7SOFT) InputCaptureISR_IC2(void)
   
   // Store current capture as last capture for next calculation
   LastCapturedTime[RIGHT_MOTOR] = CapturedTime[RIGHT_MOTOR];
+
+  ES_ISR_EXIT(ISR_PROF_IC2);
 }
 
 /****************************************************************************
@@ -652,6 +1137,8 @@ void __ISR(_INPUT_CAPTURE_2_VECTOR, IPL7SOFT) InputCaptureISR_IC2(void)
 ****************************************************************************/
 void __ISR(_TIMER_3_VECTOR, IPL6SOFT) Timer3ISR(void)
 {
+  ES_ISR_ENTER(ISR_PROF_TIMER3);
+
   // Disable interrupts globally to prevent race condition with IC ISR
   __builtin_disable_interrupts();
   
@@ -666,6 +1153,8 @@ void __ISR(_TIMER_3_VECTOR, IPL6SOFT) Timer3ISR(void)
 
   // Re-enable interrupts globally
   __builtin_enable_interrupts();
+
+  ES_ISR_EXIT(ISR_PROF_TIMER3);
 }
 
 /****************************************************************************
@@ -717,25 +1206,40 @@ uint32_t GetElapsedTicksSinceLastEdge(uint8_t motorIndex)
 
  Description
      Control Timer (Timer4) interrupt. Executes PI control algorithms
-     for both motors every 2ms to maintain desired speeds.
+     for both motors every 2ms to maintain desired speeds. The ramps,
+     feedforward and PI loops here run in soft-float, see Notes.
 
  Author
      Tianyu, 02/25/26
 ****************************************************************************/
 void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
 {  
+  ES_ISR_ENTER(ISR_PROF_CONTROL);
+
   // Clear control timer interrupt flag
   IFS0CLR = _IFS0_T4IF_MASK;
   
   // If using open-loop control, skip the PI control logic
 #if USE_OPEN_LOOP_CONTROL
+  ES_ISR_EXIT(ISR_PROF_CONTROL);
   return;
 #endif
   
+  // In position mode the outer loop sets the commanded speeds
+  if (PositionMode)
+  {
+    UpdatePositionLoop();
+  }
+
+  // Move the setpoints towards the commanded speeds within the limits
+  UpdateSetpointRamp(LEFT_MOTOR);
+  UpdateSetpointRamp(RIGHT_MOTOR);
+
   // Process control for LEFT motor
   {
-    // Read target speed for left motor
-    float targetSpeed = TargetSpeed_mm_s[LEFT_MOTOR];
+    // Read the ramped target speed for left motor
+    float targetSpeed = (RampVelocity[LEFT_MOTOR] >= 0.0f) ?
+        RampVelocity[LEFT_MOTOR] : -RampVelocity[LEFT_MOTOR];
 
     // This is avoiding stale period measurements when the motor has slowed or stalled since the last encoder edge.
     uint32_t edgePeriod    = EdgeTimeDifference[LEFT_MOTOR];
@@ -757,16 +1261,20 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
         effectivePeriod = (elapsedSince > edgePeriod * 4u) ? elapsedSince : edgePeriod;
       }
 
-    float rawSpeed = PeriodToSpeed_mm_s(effectivePeriod);
+    uint32_t rawSpeed = PeriodToSpeed_mm_s(effectivePeriod);
 
     // Clamp to physical maximum — any reading above this is a measurement artifact
     if (rawSpeed > SPEED_FULL_MM_S) { rawSpeed = SPEED_FULL_MM_S; }
 
+#if USE_SPEED_ESTIMATOR
+    float measuredSpeed = UpdateSpeedEstimate(LEFT_MOTOR, rawSpeed);
+#else
     // Exponential moving average — smooths spikes without adding much lag
     FilteredSpeed[LEFT_MOTOR] = MEAS_SPEED_ALPHA * rawSpeed
                               + (1.0f - MEAS_SPEED_ALPHA) * FilteredSpeed[LEFT_MOTOR];
 
     float measuredSpeed = FilteredSpeed[LEFT_MOTOR];
+#endif
 
     // Update monitoring variables
     CurrentDesiredSpeed[LEFT_MOTOR] = targetSpeed;
@@ -785,7 +1293,7 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
     if (integral > INTEGRAL_CLAMP_TICKS)  { integral = INTEGRAL_CLAMP_TICKS; }
     if (integral < -INTEGRAL_CLAMP_TICKS) { integral = -INTEGRAL_CLAMP_TICKS; }
 
-    float u_unsat = proportional + integral;
+    float u_unsat = FeedforwardDuty(targetSpeed) + proportional + integral;
     
     // Clamp output to duty cycle limits
     int16_t u_sat = ClampDutyCycle(u_unsat);
@@ -819,8 +1327,9 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
   
   // Process control for RIGHT motor
   {
-    // Read target speed for right motor
-    float targetSpeed = TargetSpeed_mm_s[RIGHT_MOTOR];
+    // Read the ramped target speed for right motor
+    float targetSpeed = (RampVelocity[RIGHT_MOTOR] >= 0.0f) ?
+        RampVelocity[RIGHT_MOTOR] : -RampVelocity[RIGHT_MOTOR];
     
     // This is avoiding stale period measurements when the motor has slowed or stalled since the last encoder edge.
     uint32_t edgePeriod    = EdgeTimeDifference[RIGHT_MOTOR];
@@ -842,16 +1351,20 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
         effectivePeriod = (elapsedSince > edgePeriod * 4u) ? elapsedSince : edgePeriod;
       }
 
-    float rawSpeed = PeriodToSpeed_mm_s(effectivePeriod);
+    uint32_t rawSpeed = PeriodToSpeed_mm_s(effectivePeriod);
 
     // Clamp to physical maximum — any reading above this is a measurement artifact
     if (rawSpeed > SPEED_FULL_MM_S) { rawSpeed = SPEED_FULL_MM_S; }
 
+#if USE_SPEED_ESTIMATOR
+    float measuredSpeed = UpdateSpeedEstimate(RIGHT_MOTOR, rawSpeed);
+#else
     // Exponential moving average — smooths spikes without adding much lag
     FilteredSpeed[RIGHT_MOTOR] = MEAS_SPEED_ALPHA * rawSpeed
                               + (1.0f - MEAS_SPEED_ALPHA) * FilteredSpeed[RIGHT_MOTOR];
 
     float measuredSpeed = FilteredSpeed[RIGHT_MOTOR];
+#endif
 
     // Update monitoring variables
     CurrentDesiredSpeed[RIGHT_MOTOR] = targetSpeed;
@@ -870,7 +1383,7 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
     if (integral > INTEGRAL_CLAMP_TICKS)  { integral = INTEGRAL_CLAMP_TICKS; }
     if (integral < -INTEGRAL_CLAMP_TICKS) { integral = -INTEGRAL_CLAMP_TICKS; }
 
-    float u_unsat = proportional + integral;
+    float u_unsat = FeedforwardDuty(targetSpeed) + proportional + integral;
     
     // Clamp output to duty cycle limits
     int16_t u_sat = ClampDutyCycle(u_unsat);
@@ -902,11 +1415,13 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
     DesiredSpeed[RIGHT_MOTOR] = u_sat;
   }
   
-  // Post motor action change event to update PWM outputs
-  ES_Event_t ControlEvent;
-  ControlEvent.EventType = ES_MOTOR_ACTION_CHANGE;
-  ControlEvent.EventParam = 0;
-  PostDCMotorService(ControlEvent);
+  // Look for stalled or slipping wheels, may cut the duties just set
+  CheckDriveFaults();
+
+  // Have the task level post the motor action change to update PWM outputs
+  _HW_RaiseBottomHalf(BH_MOTOR_CONTROL);
+
+  ES_ISR_EXIT(ISR_PROF_CONTROL);
 
 //  // Print monitoring info every 500ms (250 calls * 2ms period)
 //  static uint16_t printCount = 0;
@@ -931,6 +1446,599 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
  Private Functions
  ***************************************************************************/
 
+/****************************************************************************
+ Function
+     MotorControlBottomHalf
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Bottom half of ControlTimerISR, run by _HW_Process_Pending_Ints.
+     Posts ES_MOTOR_ACTION_CHANGE so the new duty cycles reach the PWM
+     outputs. Control periods raised since the last pass collapse into one
+     post since only the latest duties matter. Also posts any stall or slip
+     found by CheckDriveFaults to MainLogicFSM, ES_MOVE_SETTLED at the end
+     of a position move to NavigationFSM, and with BATTERY_SENSE refreshes
+     the battery voltage once BATT_SAMPLE_INTERVAL_MS has passed since the
+     last read. The interval comes from the framework time rather than a
+     pass count, since merged control periods make fewer passes than
+     periods.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void MotorControlBottomHalf(void)
+{
+  ES_Event_t ControlEvent;
+  uint32_t   Faults;
+#if BATTERY_SENSE
+  uint16_t   Now;
+#endif
+
+  ControlEvent.EventType = ES_MOTOR_ACTION_CHANGE;
+  ControlEvent.EventParam = 0;
+  PostDCMotorService(ControlEvent);
+
+#if BATTERY_SENSE
+  // the ADC is shared with NavigationFSM, so it is only read at task level
+  Now = ES_Timer_GetTime();
+  if ((uint16_t)(Now - LastBatterySampleTime) >= BATT_SAMPLE_INTERVAL_MS)
+  {
+    LastBatterySampleTime = Now;
+    UpdateBatteryVoltage();
+  }
+#endif
+
+  Faults = ES_AtomicExchange(&PendingFaults, 0);
+  if (Faults & MOTOR_FAULT_STALL_MASK)
+  {
+    ControlEvent.EventType  = ES_MOTOR_STALL;
+    ControlEvent.EventParam = (uint16_t)(Faults & MOTOR_FAULT_STALL_MASK);
+    PostMainLogicFSM(ControlEvent);
+  }
+  if (Faults & MOTOR_FAULT_SLIP_MASK)
+  {
+    ControlEvent.EventType  = ES_WHEEL_SLIP;
+    ControlEvent.EventParam = (uint16_t)(Faults & MOTOR_FAULT_SLIP_MASK);
+    PostMainLogicFSM(ControlEvent);
+  }
+
+  if (ES_AtomicExchange(&PendingMoveDone, 0) != 0)
+  {
+    ControlEvent.EventType  = ES_MOVE_SETTLED;
+    ControlEvent.EventParam = 0;
+    PostNavigationFSM(ControlEvent);
+  }
+}
+
+/****************************************************************************
+ Function
+     RestartDriveSupervision
+
+ Parameters
+     bool straightMove - both wheels are to travel the same way at the
+                         same rate, so slip checking applies
+
+ Returns
+     None
+
+ Description
+     Called for each new speed command or position move. Takes a fresh
+     slip baseline and re-arms the stall and slip reports and the drive.
+     CheckDriveFaults read-modifies the same state from the control ISR, so
+     the reset runs with interrupts off.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void RestartDriveSupervision(bool straightMove)
+{
+  EnterCritical();
+  SlipDivergence  = 0;
+  SlipTravel      = 0;
+  SlipLastCount[LEFT_MOTOR]  = ICEventCount[LEFT_MOTOR];
+  SlipLastCount[RIGHT_MOTOR] = ICEventCount[RIGHT_MOTOR];
+  SlipCheckActive = straightMove;
+  FaultsReported  = 0;
+  DriveCut        = false;
+  ExitCritical();
+}
+
+/****************************************************************************
+ Function
+     UpdatePositionLoop
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Outer loop of position mode, called from ControlTimerISR before the
+     ramps. Adds each wheel's new IC events to its travel, with the sign of
+     the direction it was driven, and sets TargetSpeed_mm_s and
+     CommandedDirection from the remaining distance as described at the
+     POS_* defines. Backs up past an overshoot. Once both wheels have
+     arrived and slowed for POS_SETTLE_PERIODS the move ends with both
+     targets at zero and ES_MOVE_SETTLED is raised for the bottom half.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void UpdatePositionLoop(void)
+{
+  uint8_t  i;
+  uint32_t count;
+  uint32_t delta;
+  int32_t  remaining;
+  int32_t  distance;
+  uint32_t command;       // mm/s
+  uint64_t speed;         // mm/s, before the clamp to PosMaxSpeed
+  uint64_t stopSquared;   // (mm/s)^2 that can still stop in distance
+  bool     settled = true;
+
+  for (i = 0; i < 2; i++)
+  {
+    count = ICEventCount[i];
+    // a count below the last one means it was reset in between
+    delta = (count >= PosLastCount[i]) ? (count - PosLastCount[i]) : count;
+    PosLastCount[i] = count;
+    if (DesiredDirection[i] == PosDirection[i])
+    {
+      PosTravel[i] += (int32_t)delta;
+    }
+    else
+    {
+      PosTravel[i] -= (int32_t)delta;
+    }
+
+    remaining = PosTarget_um[i] -
+        (int32_t)(((int64_t)PosTravel[i] * EST_STEP_UM_Q16) >> 16);
+    distance = (remaining >= 0) ? remaining : -remaining;
+
+    if (distance <= POS_TOLERANCE_UM)
+    {
+      PosArrived[i] = true;
+    }
+    else if (distance > POS_RESUME_UM)
+    {
+      PosArrived[i] = false;
+    }
+
+    command = 0u;
+    if (!PosArrived[i])
+    {
+      // clamp before narrowing so a long move cannot wrap the command
+      speed = ((uint64_t)distance * POS_KP_Q16) >> 16;
+      if (speed > PosMaxSpeed)
+      {
+        speed = PosMaxSpeed;
+      }
+      command = (uint32_t)speed;
+      // v^2 = 2 a d. After the clamp command is at most PosMaxSpeed, a
+      // uint16_t, so the root is only taken of a value below 2^32
+      stopSquared = ((uint64_t)distance * POS_STOP_V2_Q16) >> 16;
+      if (((uint64_t)command * command) > stopSquared)
+      {
+        command = IntegerSqrt((uint32_t)stopSquared);
+      }
+      if (command < POS_MIN_SPEED_MM_S)
+      {
+        command = POS_MIN_SPEED_MM_S;
+      }
+    }
+
+    // the ramps and PI loop downstream take a float setpoint
+    TargetSpeed_mm_s[i] = (float)command;
+    if (remaining >= 0)
+    {
+      CommandedDirection[i] = PosDirection[i];
+    }
+    else
+    {
+      CommandedDirection[i] = (PosDirection[i] == FORWARD) ? REVERSE : FORWARD;
+    }
+
+    if (!PosArrived[i] || (CurrentMeasuredSpeed[i] >= POS_SETTLE_SPEED_MM_S))
+    {
+      settled = false;
+    }
+  }
+
+  if (!settled)
+  {
+    PosSettlePeriods = 0;
+  }
+  else if (++PosSettlePeriods >= POS_SETTLE_PERIODS)
+  {
+    TargetSpeed_mm_s[LEFT_MOTOR]  = 0.0f;
+    TargetSpeed_mm_s[RIGHT_MOTOR] = 0.0f;
+    PositionMode    = false;
+    PendingMoveDone = 1;
+  }
+}
+
+/****************************************************************************
+ Function
+     CheckDriveFaults
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Called from ControlTimerISR after both PI loops. Flags a wheel as
+     stalled when it is driven near full duty but turns at under
+     1/STALL_SPEED_DIVISOR of its target for STALL_CONFIRM_PERIODS, and
+     flags slip when the wheels' IC counts drift apart on a straight move.
+     Each fault is raised once per speed command. With STALL_CUTS_DRIVE a
+     stall zeroes both duties and integrators until the next new command.
+
+     Slip is accumulated from per-period count deltas, so a
+     DCMotor_ResetICEventCount mid-move costs at most one period's counts
+     rather than looking like a huge divergence.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void CheckDriveFaults(void)
+{
+  uint8_t  NewFaults = 0;
+  uint8_t  i;
+  uint32_t Count;
+  uint32_t Delta[2];
+  uint32_t Ahead;
+
+  for (i = 0; i < 2; i++)
+  {
+    if (SpinUpPeriods[i] > 0)
+    {
+      SpinUpPeriods[i]--;
+      StallPeriods[i] = 0;
+    }
+    else if ((CurrentDesiredSpeed[i] > 0.0f) &&
+             (CurrentDutyCycleTicks[i] >= STALL_DUTY_TICKS) &&
+             ((CurrentMeasuredSpeed[i] * STALL_SPEED_DIVISOR) <
+              CurrentDesiredSpeed[i]))
+    {
+      if (StallPeriods[i] < STALL_CONFIRM_PERIODS)
+      {
+        StallPeriods[i]++;
+      }
+      else
+      {
+        NewFaults |= (uint8_t)(MOTOR_FAULT_STALL_LEFT << i);
+      }
+    }
+    else
+    {
+      StallPeriods[i] = 0;
+    }
+  }
+
+  if (SlipCheckActive)
+  {
+    for (i = 0; i < 2; i++)
+    {
+      Count = ICEventCount[i];
+      // a count below the last one means it was reset in between
+      Delta[i] = (Count >= SlipLastCount[i]) ? (Count - SlipLastCount[i]) : Count;
+      SlipLastCount[i] = Count;
+    }
+    SlipDivergence += (int32_t)Delta[LEFT_MOTOR] - (int32_t)Delta[RIGHT_MOTOR];
+    SlipTravel     += Delta[LEFT_MOTOR] + Delta[RIGHT_MOTOR];
+
+    Ahead = (SlipDivergence >= 0) ? (uint32_t)SlipDivergence :
+                                    (uint32_t)(-SlipDivergence);
+    if (Ahead > (SLIP_MIN_EVENTS + (SlipTravel >> SLIP_TRAVEL_SHIFT)))
+    {
+      NewFaults |= (SlipDivergence > 0) ? MOTOR_FAULT_SLIP_LEFT :
+                                          MOTOR_FAULT_SLIP_RIGHT;
+    }
+  }
+
+  NewFaults &= (uint8_t)~FaultsReported;
+  if (NewFaults != 0)
+  {
+    FaultsReported |= NewFaults;
+    ES_AtomicSetBits(&PendingFaults, NewFaults);
+    if (STALL_CUTS_DRIVE && (NewFaults & MOTOR_FAULT_STALL_MASK))
+    {
+      DriveCut = true;
+    }
+  }
+
+  if (DriveCut)
+  {
+    for (i = 0; i < 2; i++)
+    {
+      AccumulatedError[i]      = 0.0f;
+      CurrentDutyCycleTicks[i] = 0;
+      LastDutyCycleTicks[i]    = 0;
+      DesiredSpeed[i]          = 0;
+    }
+  }
+}
+
+/****************************************************************************
+ Function
+     UpdateSetpointRamp
+
+ Parameters
+     uint8_t motorIndex - LEFT_MOTOR or RIGHT_MOTOR
+
+ Returns
+     None
+
+ Description
+     Called from ControlTimerISR once per wheel per control period. Moves
+     RampVelocity towards the signed commanded velocity with limited
+     acceleration and, if RampJerkStep is non-zero, limited jerk:
+     the acceleration grows by RampJerkStep per period up to the accel or
+     decel limit, and starts falling again once the remaining velocity
+     error is no more than what is covered while it winds down to zero
+     (a^2 / 2j), so the setpoint arrives without overshoot.
+     Sets DesiredDirection from the sign of the ramp.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void UpdateSetpointRamp(uint8_t motorIndex)
+{
+  float command = (CommandedDirection[motorIndex] == FORWARD) ?
+      TargetSpeed_mm_s[motorIndex] : -TargetSpeed_mm_s[motorIndex];
+  float velocity = RampVelocity[motorIndex];
+  float accel    = RampAccel[motorIndex];
+  float error    = command - velocity;
+  float sign     = (error >= 0.0f) ? 1.0f : -1.0f;
+  // moving towards zero speed is decelerating
+  bool  slowing  = (velocity != 0.0f) && ((velocity > 0.0f) != (error > 0.0f));
+  float limit    = slowing ? RampDecelStep : RampAccelStep;
+
+  if ((TargetSpeed_mm_s[motorIndex] == 0.0f) && RampBypass)
+  {
+    velocity = 0.0f;
+    accel    = 0.0f;
+  }
+  else if (RampJerkStep <= 0.0f)
+  {
+    // slew limit only
+    accel = sign * limit;
+    if ((error * sign) < limit)
+    {
+      accel = error;
+    }
+    velocity += accel;
+  }
+  else
+  {
+    float windDown = (accel * accel) / (2.0f * RampJerkStep);
+
+    if (((accel * sign) > 0.0f) && ((error * sign) <= windDown))
+    {
+      // close enough: let the acceleration fall back towards zero
+      accel -= sign * RampJerkStep;
+      if ((accel * sign) < 0.0f)
+      {
+        accel = 0.0f;
+      }
+    }
+    else
+    {
+      accel += sign * RampJerkStep;
+      if ((accel * sign) > limit)
+      {
+        accel = sign * limit;
+      }
+    }
+    velocity += accel;
+
+    // landed on or passed the command: hold it there
+    if (((command - velocity) * sign) <= 0.0f)
+    {
+      velocity = command;
+      accel    = 0.0f;
+    }
+  }
+
+  RampVelocity[motorIndex] = velocity;
+  RampAccel[motorIndex]    = accel;
+
+  uint8_t direction = CommandedDirection[motorIndex];
+  if (velocity > 0.0f)
+  {
+    direction = FORWARD;
+  }
+  else if (velocity < 0.0f)
+  {
+    direction = REVERSE;
+  }
+  if (direction != DesiredDirection[motorIndex])
+  {
+    // the integral built up driving the other way does not apply now
+    AccumulatedError[motorIndex] = 0.0f;
+    DesiredDirection[motorIndex] = direction;
+  }
+}
+
+/****************************************************************************
+ Function
+     UpdateSpeedEstimate
+
+ Parameters
+     uint8_t  motorIndex    - LEFT_MOTOR or RIGHT_MOTOR
+     uint32_t measured_mm_s - speed from the (stale-corrected) IC period
+
+ Returns
+     float - estimated wheel speed in mm/s for the PI loop
+
+ Description
+     One step of the per-wheel steady-state Kalman filter, integer only.
+     Predict: position advances by v*TS; speed moves EST_MODEL_Q32 of the
+     way towards the steady-state speed for last period's duty and gains
+     the disturbance times TS. Correct: position is measured as the IC
+     count in um plus v * time since the last capture, capped at one IC
+     event since no further edge has arrived; speed is measured from the
+     period. Both innovations go through the EST_K_* gains.
+
+     A drop in the IC count is a DCMotor_ResetICEventCount, and moves the
+     position back by the same amount so the sub-event part is kept.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static float UpdateSpeedEstimate(uint8_t motorIndex, uint32_t measured_mm_s)
+{
+  int32_t  p = EstPosition_um[motorIndex];
+  int32_t  v = EstVelocity_um_s[motorIndex];
+  int32_t  d = EstDisturbance_um_s2[motorIndex];
+  int32_t  steadyState = 0;
+  int32_t  dutyAbove;
+  uint32_t count;
+  uint32_t elapsed;
+  int32_t  extrapolated;
+  int32_t  measuredPosition;
+  int32_t  errorP;
+  int32_t  errorV;
+
+  // predict, with the duty that was applied over the last period
+  dutyAbove = (int32_t)LastDutyCycleTicks[motorIndex] - DeadbandTicks;
+  if (dutyAbove > 0)
+  {
+    steadyState = (int32_t)(((int64_t)dutyAbove * DutyToSpeedQ16) >> 16);
+  }
+  p += (int32_t)(((int64_t)v * EST_TS_Q32) >> 32);
+  v += (int32_t)((((int64_t)(steadyState - v) * EST_MODEL_Q32) +
+                  ((int64_t)d * EST_TS_Q32)) >> 32);
+
+  // measure; re-read if an edge lands between the count and its timestamp
+  do
+  {
+    count   = ICEventCount[motorIndex];
+    elapsed = GetElapsedTicksSinceLastEdge(motorIndex);
+  } while (count != ICEventCount[motorIndex]);
+
+  if (count < EstLastCount[motorIndex])
+  {
+    p -= (int32_t)(((uint64_t)(EstLastCount[motorIndex] - count) *
+                    EST_STEP_UM_Q16) >> 16);
+  }
+  EstLastCount[motorIndex] = count;
+
+  if (elapsed > EST_MAX_ELAPSED_TICKS)
+  {
+    elapsed = EST_MAX_ELAPSED_TICKS;
+  }
+  extrapolated = (v > 0) ?
+      (int32_t)(((int64_t)v * elapsed * EST_TICK_S_Q32) >> 32) : 0;
+  if (extrapolated > (int32_t)(EST_STEP_UM_Q16 >> 16))
+  {
+    extrapolated = (int32_t)(EST_STEP_UM_Q16 >> 16);
+  }
+  measuredPosition = (int32_t)(((uint64_t)count * EST_STEP_UM_Q16) >> 16) +
+                     extrapolated;
+
+  // correct
+  errorP = measuredPosition - p;
+  errorV = (int32_t)(measured_mm_s * 1000u) - v;
+  p += (int32_t)(((int64_t)EST_K_PP * errorP + (int64_t)EST_K_PV * errorV) >> 16);
+  v += (int32_t)(((int64_t)EST_K_VP * errorP + (int64_t)EST_K_VV * errorV) >> 16);
+  d += (int32_t)(((int64_t)EST_K_DP * errorP + (int64_t)EST_K_DV * errorV) >> 16);
+
+  // the encoders do not see direction, so this is a speed magnitude
+  if (v < 0)
+  {
+    v = 0;
+  }
+
+  EstPosition_um[motorIndex]       = p;
+  EstVelocity_um_s[motorIndex]     = v;
+  EstDisturbance_um_s2[motorIndex] = d;
+  return (float)v * 0.001f;
+}
+
+/****************************************************************************
+ Function
+     FeedforwardDuty
+
+ Parameters
+     float targetSpeed - ramped setpoint magnitude in mm/s
+
+ Returns
+     float - duty ticks expected to hold targetSpeed at the present battery
+             voltage, 0 for a stopped wheel or with USE_FEEDFORWARD false
+
+ Description
+     Called from ControlTimerISR for each wheel; the PI output is added
+     on top. Static gain plus deadband, scaled by FeedforwardScale.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static float FeedforwardDuty(float targetSpeed)
+{
+  if (!USE_FEEDFORWARD || (targetSpeed <= 0.0f))
+  {
+    return 0.0f;
+  }
+  return (FF_DEADBAND_TICKS + FF_GAIN_TICKS_PER_MM_S * targetSpeed) *
+         FeedforwardScale;
+}
+
+#if BATTERY_SENSE
+/****************************************************************************
+ Function
+     UpdateBatteryVoltage
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Reads the ADC scan set, converts the battery channel to mV and folds
+     it into BatteryVoltage_mV with a 1/2^BATT_FILTER_SHIFT IIR, then
+     updates FeedforwardScale and the estimator's DutyToSpeedQ16 and
+     DeadbandTicks. Readings outside BATT_MIN_VALID_MV to
+     BATT_MAX_VALID_MV are dropped so an unset ADC or loose divider leaves
+     the feedforward at its last good value. Task level only.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void UpdateBatteryVoltage(void)
+{
+  uint32_t adcResults[ADC_NUM_CHANNELS] = {0u};  // in case the scan is not set up yet
+  uint32_t reading_mV;
+
+  ADC_MultiRead(adcResults);
+  reading_mV = (adcResults[ADC_IDX_BATTERY] * BATT_MV_PER_COUNT_NUM) >>
+               BATT_MV_PER_COUNT_SHIFT;
+  if ((reading_mV < BATT_MIN_VALID_MV) || (reading_mV > BATT_MAX_VALID_MV))
+  {
+    return;
+  }
+
+  BatteryVoltage_mV = (uint16_t)(BatteryVoltage_mV +
+      (((int32_t)reading_mV - (int32_t)BatteryVoltage_mV) >> BATT_FILTER_SHIFT));
+  // a single aligned float store, the ISR sees the old or the new scale
+  FeedforwardScale = (float)BATT_NOMINAL_MV / (float)BatteryVoltage_mV;
+  DutyToSpeedQ16 = (int32_t)((1000.0f * 65536.0f / FF_GAIN_TICKS_PER_MM_S) /
+                             FeedforwardScale);
+  // the ISR may pair the new deadband with the old gain for one control
+  // period, which only skews one predict step of the estimator
+  DeadbandTicks  = (int32_t)(FF_DEADBAND_TICKS * FeedforwardScale + 0.5f);
+}
+#endif
+
 /****************************************************************************
  Function
      PeriodToRPM
@@ -939,32 +2047,26 @@ void __ISR(_TIMER_4_VECTOR, IPL5SOFT) ControlTimerISR(void)
      uint32_t period - time between encoder edges in timer ticks
 
  Returns
-     float - measured RPM
+     uint32_t - measured RPM, 0 if period is 0
 
  Description
      LOCAL version for PI controller use only. Converts encoder period
      measurement to RPM. Uses hardware-verified constants from CommonDefinitions.h.
+     RPM = (TIMER3_CLOCK_HZ * 60) / (IC_EVENTS_PER_REV * period), through
+     ReciprocalDivide so it costs no divide or float.
 
  Author
      Tianyu, 03/01/26
 ****************************************************************************/
-static float PeriodToRPM(uint32_t period)
+static uint32_t PeriodToRPM(uint32_t period)
 {
-  // Prevent division by zero
-  if (period == 0u)
+  // Prevent division by zero and keep the denominator from wrapping
+  if ((period == 0u) || (period > (0xFFFFFFFFu / IC_EVENTS_PER_REV)))
   {
-    return 0.0f;
+    return 0u;
   }
-  
-  // Timer3 clock is TIMER3_CLOCK_HZ = 78125 Hz
-  // Each IC capture represents IC_EVENTS_PER_REV per revolution
-  // Convert to rev/s: (TIMER3_CLOCK_HZ / IC_EVENTS_PER_REV) / period
-  // Convert to RPM: rev/s * 60
-  
-  float rev_per_sec = (float)TIMER3_CLOCK_HZ / ((float)IC_EVENTS_PER_REV * (float)period);
-  float rpm = rev_per_sec * 60.0f;
-  
-  return rpm;
+
+  return ReciprocalDivide(TIMER3_CLOCK_HZ * 60u, IC_EVENTS_PER_REV * period);
 }
 
 /****************************************************************************
@@ -32,6 +32,14 @@
  -------------- ---     --------
  02/03/26       Tianyu  Initial creation for Lab 8 main logic
  03/01/26       Team    Added calibration and deterministic test sequence
+ 10/17/26       Team    give up a behavior at once on ES_MOTOR_STALL, log
+                        ES_WHEEL_SLIP
+ 10/17/26       Team    SearchBeaconLR sweeps through the beam, then turns
+                        back to the beacon's bearing
+ 10/17/26       Team    ES_MOTOR_STALL backs off and retries the behavior,
+                        stops the sequence after STALL_MAX_RETRIES; dropped
+                        the ES_WHEEL_SLIP log
+ 10/17/26       Team    stalls stop with Nav_EmergencyStop, no ramp down
 ****************************************************************************/
 
 /*----------------------------- Include Files -----------------------------*/
@@ -59,6 +67,15 @@
 // no parameter filtering is applied — any event of the expected type advances.
 #define COMPLETION_ANY_PARAM  0xFFFFu
 
+// Time for the robot to coast to a stop after a beacon sweep before the
+// angle turned is read back
+#define SWEEP_SETTLE_MS       300u
+
+// Stall recovery: back away this far and retry the stalled behavior, at
+// most STALL_MAX_RETRIES times before stopping the sequence
+#define STALL_BACKOFF_MM      40u
+#define STALL_MAX_RETRIES     2u
+
 /*---------------------------- Module Functions ---------------------------*/
 // Top-level behaviors
 static void Behavior_Calibrate(void);
@@ -87,6 +104,8 @@ static void Behavior_SearchBeaconBGAgain(void);
 static void Behavior_FollowForwardToLeftIntersection(void);
 static void Behavior_RotateCW180(void);
 static void Behavior_SearchBeaconLR(void);
+static void Behavior_SettleSweep(void);
+static void Behavior_TurnToBeacon(void);
 static void Behavior_AdjustShootDistance2(void);
 static void Behavior_ShootSequence2(void);
 static void Behavior_FollowForwardToLeftIntersection2(void);
@@ -114,6 +133,7 @@ static void BallCollection_RetractScoop(void);
 static void AdvanceMainSequence(void);
 static void AdvanceCollectionSequence(void);
 static void Behavior_RecoverTapeLost(void);
+static void Behavior_RecoverStall(void);
 
 /*---------------------------- Module Variables ---------------------------*/
 static MainLogicState_t CurrentState;
@@ -122,6 +142,7 @@ static uint8_t MyPriority;
 // Tape lost recovery state
 static bool IsRecovering = false;
 static uint8_t LastNavIntent = NAV_INTENT_FORWARD;
+static uint8_t StallRetries = 0;  // stall recoveries of the current behavior
 
 // Set by each behavior function to declare which event completes it.
 // RunMainLogicFSM only advances the sequence when the received event
@@ -145,6 +166,10 @@ static bool BeaconRLFilter = false;
 // 'b' = blue field, 'g' = green field, 0 = not yet detected.
 static char FieldSide = 0;
 
+// Beacon Behavior_SearchBeaconLR swept for, 0 if it skipped the sweep.
+// Behavior_TurnToBeacon turns back to its bearing.
+static char SweepBeacon = 0;
+
 // Stores the odometer IC event count recorded during Behavior_RecordOdometer.
 // Used by Behavior_MoveBackward_Odometer to calculate reverse distance.
 static uint32_t RecordedOdometerCount = 0;
@@ -194,6 +219,8 @@ static const BehaviorFn_t BehaviorSequence[] = {
   
   Behavior_FollowForwardToT,
   Behavior_SearchBeaconLR,
+  Behavior_SettleSweep,
+  Behavior_TurnToBeacon,
   Behavior_AdjustShootDistance2,
   Behavior_ShootSequence2,
 
@@ -345,6 +372,29 @@ ES_Event_t RunMainLogicFSM(ES_Event_t ThisEvent)
         ThisEvent.EventParam = COMPLETION_ANY_PARAM;
         PostMainLogicFSM(ThisEvent);
       }
+      // A stalled wheel (pinned against a wall or the dispenser) will not
+      // finish the behavior. DCMotorService has already cut the drive;
+      // back away and retry the behavior, or stop if it keeps stalling.
+      else if (ThisEvent.EventType == ES_MOTOR_STALL)
+      {
+        Nav_EmergencyStop();
+        if (StallRetries < STALL_MAX_RETRIES)
+        {
+          StallRetries++;
+          DB_printf("MainLogic: Stall (0x%x) in behavior %u, retry %u\r\n",
+                    (unsigned)ThisEvent.EventParam, (unsigned)BehaviorIdx,
+                    (unsigned)StallRetries);
+          IsRecovering = true;
+          Behavior_RecoverStall();
+        }
+        else
+        {
+          DB_printf("MainLogic: Stall (0x%x) in behavior %u, stopping\r\n",
+                    (unsigned)ThisEvent.EventParam, (unsigned)BehaviorIdx);
+          IsRecovering = false;
+          CurrentState = ML_Stopped;
+        }
+      }
       else if (ThisEvent.EventType == ES_LINE_LOST)
       {
         // If the current behavior EXPECTS line lost as its completion,
@@ -400,6 +450,11 @@ ES_Event_t RunMainLogicFSM(ES_Event_t ThisEvent)
 
         if (paramOk)
         {
+          // The sweep has passed the beacon's beam, stop turning
+          if (ThisEvent.EventType == ES_BEACON_BEARING)
+          {
+            Nav_Stop();
+          }
           if (IsRecovering)
           {
             IsRecovering = false;
@@ -440,6 +495,14 @@ ES_Event_t RunMainLogicFSM(ES_Event_t ThisEvent)
         DB_printf("MainLogic: BallCollection timer fired, advancing\r\n");
         AdvanceCollectionSequence();
       }
+      else if (ThisEvent.EventType == ES_MOTOR_STALL)
+      {
+        // e.g. docking has reached the dispenser before its full distance
+        DB_printf("MainLogic: Stall (0x%x) during collection, advancing\r\n",
+                  (unsigned)ThisEvent.EventParam);
+        Nav_EmergencyStop();
+        AdvanceCollectionSequence();
+      }
     }
     break;
 
@@ -516,6 +579,7 @@ static void AdvanceMainSequence(void)
   ExpectedCompletionParam = COMPLETION_ANY_PARAM;
   BeaconBGFilter          = false;
   BeaconRLFilter          = false;
+  StallRetries            = 0;
 
   BehaviorIdx++;
   if (BehaviorIdx < NUM_BEHAVIORS)
@@ -940,6 +1004,41 @@ static void Behavior_RecoverTapeLost(void)
   // NavigationFSM will post ES_TAPE_FOUND when recovery succeeds
 }
 
+/****************************************************************************
+ Function
+     Behavior_RecoverStall
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Backs away STALL_BACKOFF_MM from whatever stalled the wheels, against
+     the last navigation intent. Completion via ES_BEHAVIOR_COMPLETE with
+     IsRecovering set restarts the stalled behavior.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void Behavior_RecoverStall(void)
+{
+  ExpectedCompletionEvent = ES_BEHAVIOR_COMPLETE;
+  ExpectedCompletionParam = COMPLETION_ANY_PARAM;
+  DB_printf("Behavior: RecoverStall, LastIntent=%u\r\n", (unsigned)LastNavIntent);
+
+  if (LastNavIntent == NAV_INTENT_REVERSE)
+  {
+    Nav_MoveForward_mm(STALL_BACKOFF_MM);
+  }
+  else
+  {
+    Nav_MoveBackward_mm(STALL_BACKOFF_MM);
+  }
+  // NavigationFSM posts ES_BEHAVIOR_COMPLETE when the back-off is done
+}
+
 /****************************************************************************
  Function
      Behavior_TapeFollowBackward
@@ -1547,6 +1646,8 @@ static void Behavior_RotateCW180(void)
  Description
      Searches for beacon 'l' if FieldSide == 'b', or beacon 'r' if FieldSide == 'g'.
      Determines target beacon based on field side set during SearchBeaconBG.
+     Rotates CW through the whole beam with a bearing sweep running, so
+     ES_BEACON_BEARING rather than ES_BEACON_DETECTED completes it.
 
  Author
      Team, 03/04/26
@@ -1565,20 +1666,115 @@ static void Behavior_SearchBeaconLR(void)
   if (QueryBeaconDetectFSM() == BeaconLocked &&
       QueryLockedBeaconId() == targetBeacon)
   {
+    SweepBeacon = 0;
     ExpectedCompletionEvent = ES_BEHAVIOR_COMPLETE;
     ExpectedCompletionParam = COMPLETION_ANY_PARAM;
     PostMainLogicFSM((ES_Event_t){ ES_BEHAVIOR_COMPLETE, 0 });
     return;
   }
 
-  // Rotate and wait for the specific target beacon
-  ExpectedCompletionEvent = ES_BEACON_DETECTED;
+  // Rotate until the sweep has passed the specific target beacon
+  SweepBeacon = targetBeacon;
+  ExpectedCompletionEvent = ES_BEACON_BEARING;
   ExpectedCompletionParam = (uint16_t)targetBeacon;
   // No BeaconBGFilter needed — ExpectedCompletionParam already filters
   // to exactly the right beacon character.
+  LastNavIntent = NAV_INTENT_ROTATE_CW;
+  BeaconDetect_StartSweep(true);
   Nav_StartRotateContinuous(true);
 }
 
+/****************************************************************************
+ Function
+     Behavior_SettleSweep
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Waits for the robot to stop after a beacon sweep. The sweep keeps
+     counting the coast, so the turn back starts from where the robot is.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void Behavior_SettleSweep(void)
+{
+  ExpectedCompletionEvent = ES_BEHAVIOR_COMPLETE;
+  ExpectedCompletionParam = COMPLETION_ANY_PARAM;
+  DB_printf("Behavior: SettleSweep\r\n");
+  if (SweepBeacon == 0)
+  {
+    PostMainLogicFSM((ES_Event_t){ ES_BEHAVIOR_COMPLETE, 0 });
+    return;
+  }
+  ES_Timer_InitTimer(BEHAVIOR_TIMEOUT_TIMER, SWEEP_SETTLE_MS);
+}
+
+/****************************************************************************
+ Function
+     Behavior_TurnToBeacon
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Ends the sweep and turns CCW by the angle swept past the beacon's
+     bearing, so the robot faces the centre of its beam.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void Behavior_TurnToBeacon(void)
+{
+  uint16_t bearing;
+  uint16_t swept;
+  uint16_t turnBack_deg;
+
+  ExpectedCompletionEvent = ES_BEHAVIOR_COMPLETE;
+  ExpectedCompletionParam = COMPLETION_ANY_PARAM;
+
+  if (SweepBeacon == 0)
+  {
+    PostMainLogicFSM((ES_Event_t){ ES_BEHAVIOR_COMPLETE, 0 });
+    return;
+  }
+
+  swept = QuerySweepAngle();
+  BeaconDetect_EndSweep();
+  if (!QueryBeaconBearing(SweepBeacon, &bearing) || (bearing >= swept))
+  {
+    turnBack_deg = 0;
+  }
+  else
+  {
+    // tenths of a degree, rounded, within Nav_RotateCCW's range
+    turnBack_deg = (uint16_t)((swept - bearing + 5u) / 10u);
+    if (turnBack_deg > UINT8_MAX)
+    {
+      turnBack_deg = UINT8_MAX;
+    }
+  }
+  DB_printf("Behavior: TurnToBeacon '%c' back %u deg\r\n", SweepBeacon,
+            (unsigned)turnBack_deg);
+  SweepBeacon = 0;
+
+  if (turnBack_deg == 0)
+  {
+    PostMainLogicFSM((ES_Event_t){ ES_BEHAVIOR_COMPLETE, 0 });
+    return;
+  }
+  LastNavIntent = NAV_INTENT_ROTATE_CCW;
+  Nav_RotateCCW((uint8_t)turnBack_deg);
+  // NavigationFSM posts ES_BEHAVIOR_COMPLETE when odometer arc reached
+}
+
 /****************************************************************************
  Function
      Behavior_AdjustShootDistance2
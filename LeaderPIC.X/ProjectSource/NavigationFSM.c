@@ -14,6 +14,13 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    ramp limits chosen per behavior, Nav_EmergencyStop
+ 10/17/26       Team    straight moves clamped to NAV_MAX_MOVE_MM;
+                        ROTATE_SAFETY_TIMER stopped on every completion
+ 10/17/26       Team    straight distance moves use DCMotorService
+                        position mode and wait for ES_MOVE_SETTLED
+ 10/17/26       Team    ADC scan set shared with the battery channel
+ 10/17/26       Team    declare ES_TIMEOUT deadline for EDF
  03/02/26       Team    Renamed from TapeFollowFSM to NavigationFSM
  03/01/26 00:00 Team    Initial implementation
 ****************************************************************************/
@@ -33,12 +40,26 @@
 #define TAPE_FOLLOW_INTERVAL_MS   20u     // sensor poll rate: 50 Hz
 #define BASE_FOLLOW_SPEED_MM_S    150u    // straight-line speed target in mm/s
 #define BASE_FOLLOW_SPEED_REV_MM_S    70u    // straight-line speed target in mm/s
+// Straight distance moves (Nav_MoveForward_mm, Nav_MoveBackward_mm) run in
+// DCMotorService position mode, which slows in to the target by itself,
+// so reverse moves such as docking no longer need the slower speed. Set
+// false to go back to polling the odometer at a fixed speed.
+#define NAV_POSITION_MOVES        true
+#define NAV_MOVE_SPEED_MM_S       BASE_FOLLOW_SPEED_MM_S
+// Twice the cruise time plus a second for the ramps and settling
+#define MOVE_SAFETY_TIMEOUT_MS(dist_mm) \
+  ((uint16_t)(((dist_mm) * 2000u) / NAV_MOVE_SPEED_MM_S + 1000u))
+// Longest straight move; longer requests are clamped so the safety timeout
+// fits the 16-bit ES timer. Well over the length of the field.
+#define NAV_MAX_MOVE_MM           4000u
+#if ((NAV_MAX_MOVE_MM * 2000u) / NAV_MOVE_SPEED_MM_S + 1000u) > 0xFFFFu
+#error "MOVE_SAFETY_TIMEOUT_MS(NAV_MAX_MOVE_MM) does not fit an ES timer"
+#endif
 #define LINE_KP                   5.0f   // proportional gain, tune upward from here
 #define LINE_KD                   1.5f   // derivative gain, tune after KP settled
 #define LINE_KP_REV               0.5f   // proportional gain, tune upward from here
 #define LINE_KD_REV               0.5f   // derivative gain, tune after KP settled
 #define LINE_LOST_THRESHOLD       50u      // consecutive no-tape cycles before ES_LINE_LOST
-#define TAPE_ANALOG_PINS          (BIT12HI | BIT11HI | BIT5HI)  // AN12,11,5
 #define THRESH_DIV                2       // Threshold divisor for tape detection
 
 // Fixed threshold: analog value > 600 = black tape detected
@@ -57,12 +78,25 @@
 // At SEARCH_ROTATE_SPEED_MM_S, this gives roughly 200-270 degrees of rotation.
 #define CALIB_ROTATION_MS         5000u
 
+// Setpoint ramp limits per behavior (DCMotor_SetRampLimits). Point turns
+// start gently so the wheels do not scrub and stop hard so the turn ends
+// close to the odometer count; everything else uses the DCMotorService
+// defaults.
+#define TURN_RAMP_ACCEL_MM_S2     800u
+#define TURN_RAMP_DECEL_MM_S2     6000u
+#define TURN_RAMP_JERK_MM_S3      0u
+#define DRIVE_RAMP_ACCEL_MM_S2    1500u
+#define DRIVE_RAMP_DECEL_MM_S2    3000u
+#define DRIVE_RAMP_JERK_MM_S3     30000u
+
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine */
 static void ReadTapeSensors(void);
 static void CheckFollowConditions(void);
 static bool IsOnTape(uint32_t val, uint32_t minC, uint32_t maxC);
 static void StartRotation(uint8_t leftDir, uint8_t rightDir, uint32_t targetArc_mm);
+static uint32_t ClampMoveDistance(uint32_t dist_mm);
+static void UseTurnRamps(bool pointTurn);
 
 /*---------------------------- Module Variables ---------------------------*/
 // State variable
@@ -72,7 +106,7 @@ static NavigationState_t CurrentState;
 static uint8_t MyPriority;
 
 // Tape Sensor Variables (from DCMotorService)
-static uint32_t ADValues[3] = {0, 0, 0};
+static uint32_t ADValues[ADC_NUM_CHANNELS];
 static uint32_t leftVal = 0;      // AN12
 static uint32_t rightVal = 0;     // AN11
 static uint32_t centerVal = 0;    // AN5
@@ -154,6 +188,8 @@ bool InitNavigationFSM(uint8_t Priority)
   ES_Event_t ThisEvent;
 
   MyPriority = Priority;
+  // the tape sensors are polled off ES_TIMEOUT every TAPE_FOLLOW_INTERVAL_MS
+  ES_SetDeadline(MyPriority, ES_TIMEOUT, TAPE_FOLLOW_INTERVAL_MS / 2);
   
   /********************************************
    Tape Sensor Hardware Initialization
@@ -165,6 +201,8 @@ bool InitNavigationFSM(uint8_t Priority)
   
   // Configure ADC to scan AN12 (RB12, pin23), AN11 (RB13, pin24) and AN5 (RB3, pin7)
   // Note: RB3 needs to be configured as analog for AN5
+  // The scan set also has DCMotorService's battery channel (AN3), which
+  // sets up its own pin
   TRISBbits.TRISB12 = 1;   // Set as input
   ANSELBbits.ANSB12 = 1;   // Enable analog function
   
@@ -174,14 +212,14 @@ bool InitNavigationFSM(uint8_t Priority)
   TRISBbits.TRISB3 = 1;    // Set as input  
   ANSELBbits.ANSB3 = 1;    // Enable analog function
   
-  ADC_ConfigAutoScan(TAPE_ANALOG_PINS);
+  ADC_ConfigAutoScan(ADC_SCAN_PINS);
   
   // Read initial ADC values
   ADC_MultiRead(ADValues);
   
-  centerVal = ADValues[0];   // AN5 (RB3) - listed first because lower bit number
-  rightVal = ADValues[1];    // AN11 (RB13)
-  leftVal = ADValues[2];     // AN12 (RB12)
+  centerVal = ADValues[ADC_IDX_CENTER_TAPE];   // AN5 (RB3)
+  rightVal = ADValues[ADC_IDX_RIGHT_TAPE];     // AN11 (RB13)
+  leftVal = ADValues[ADC_IDX_LEFT_TAPE];       // AN12 (RB12)
   
   // Read initial digital sensor states
   leftTState = ReadLeftTapeInputPin();
@@ -573,6 +611,7 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
         if (avg2 >= (RotateRadiusTargetLeft_mm + RotateRadiusTargetRight_mm))
         {
           DCMotor_SetSpeed_mm_s(0,0,FORWARD,FORWARD);
+          ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
           // Debug print: show final distances for each wheel
           DB_printf("Nav: Radius rotation done. dL=%u mm, dR=%u mm\r\n", (unsigned)dL, (unsigned)dR);
 
@@ -587,7 +626,8 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
                             ROTATE_POLL_INTERVAL_MS);
         }
       }
-      else if (ThisEvent.EventParam == ROTATE_SAFETY_TIMER)
+      else if (ThisEvent.EventType == ES_TIMEOUT &&
+               ThisEvent.EventParam == ROTATE_SAFETY_TIMER)
       {
         DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
         DB_printf("Nav: Radius rotate safety timeout\r\n");
@@ -611,6 +651,7 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
         if (avg >= MoveTargetDist_mm)
         {
           DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+          ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
           DB_printf("Nav: MoveForward done, avg=%u mm\r\n", (unsigned)avg);
           ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
           PostMainLogicFSM(ev);
@@ -621,9 +662,29 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
           ES_Timer_InitTimer(TAPE_FOLLOW_TIMER, ROTATE_POLL_INTERVAL_MS);
         }
       }
+      else if (ThisEvent.EventType == ES_MOVE_SETTLED)
+      {
+        ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
+        DB_printf("Nav: MoveForward settled, L=%u mm, R=%u mm\r\n",
+                  ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR)) - MoveStartDistLeft_mm,
+                  ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR)) - MoveStartDistRight_mm);
+        ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
+        PostMainLogicFSM(ev);
+        CurrentState = NavIdle;
+      }
+      else if (ThisEvent.EventType == ES_TIMEOUT &&
+               ThisEvent.EventParam == ROTATE_SAFETY_TIMER)
+      {
+        DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+        DB_printf("Nav: MoveForward safety timeout\r\n");
+        ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
+        PostMainLogicFSM(ev);
+        CurrentState = NavIdle;
+      }
       else if (ThisEvent.EventType == ES_STOP_LINE_FOLLOW)
       {
         DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+        ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
         CurrentState = NavIdle;
       }
     }
@@ -645,6 +706,7 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
                  curR - MoveBackStartDistRight_mm >= MoveBackTargetDist_mm)
         {
           DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+          ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
           DB_printf("Nav: MoveBackward done, avg=%u mm\r\n", (unsigned)((curL + curR) / 2u));
           ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
           PostMainLogicFSM(ev);
@@ -662,9 +724,29 @@ ES_Event_t RunNavigationFSM(ES_Event_t ThisEvent)
         }
         ES_Timer_InitTimer(TAPE_FOLLOW_TIMER, ROTATE_POLL_INTERVAL_MS);
       }
+      else if (ThisEvent.EventType == ES_MOVE_SETTLED)
+      {
+        ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
+        DB_printf("Nav: MoveBackward settled, L=%u mm, R=%u mm\r\n",
+                  ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR)) - MoveBackStartDistLeft_mm,
+                  ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR)) - MoveBackStartDistRight_mm);
+        ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
+        PostMainLogicFSM(ev);
+        CurrentState = NavIdle;
+      }
+      else if (ThisEvent.EventType == ES_TIMEOUT &&
+               ThisEvent.EventParam == ROTATE_SAFETY_TIMER)
+      {
+        DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+        DB_printf("Nav: MoveBackward safety timeout\r\n");
+        ES_Event_t ev = { ES_BEHAVIOR_COMPLETE, 0 };
+        PostMainLogicFSM(ev);
+        CurrentState = NavIdle;
+      }
       else if (ThisEvent.EventType == ES_STOP_LINE_FOLLOW)
       {
         DCMotor_SetSpeed_mm_s(0, 0, FORWARD, FORWARD);
+        ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
         CurrentState = NavIdle;
       }
     }
@@ -901,9 +983,9 @@ static void ReadTapeSensors(void)
 {
   // Read analog sensors
   ADC_MultiRead(ADValues);
-  centerVal = ADValues[0];   // AN5 (RB3)
-  rightVal = ADValues[1];    // AN11 (RB13)
-  leftVal = ADValues[2];     // AN12 (RB12)
+  centerVal = ADValues[ADC_IDX_CENTER_TAPE];   // AN5 (RB3)
+  rightVal = ADValues[ADC_IDX_RIGHT_TAPE];     // AN11 (RB13)
+  leftVal = ADValues[ADC_IDX_LEFT_TAPE];       // AN12 (RB12)
 
   if (centerVal > 0u && centerVal < MinCenterC) MinCenterC = centerVal;
   if (centerVal > MaxCenterC)                   MaxCenterC = centerVal;
@@ -1050,6 +1132,7 @@ static void CheckFollowConditions(void)
 ****************************************************************************/
 void Nav_StartRotateSearch(bool clockwise)
 {
+  UseTurnRamps(true);
   lastError     = 0;
   lineLostCount = 0;
   
@@ -1085,6 +1168,7 @@ void Nav_StartRotateSearch(bool clockwise)
 ****************************************************************************/
 void Nav_StartCalibration(void)
 {
+  UseTurnRamps(true);
   lastError              = 0;
   lineLostCount          = 0;
   tIntersectionPublished = false;
@@ -1126,6 +1210,7 @@ void Nav_StartCalibration(void)
 ****************************************************************************/
 void Nav_StartDriveSearch(bool forward)
 {
+  UseTurnRamps(false);
   lastError     = 0;
   lineLostCount = 0;
   
@@ -1158,6 +1243,7 @@ void Nav_StartDriveSearch(bool forward)
 ****************************************************************************/
 void Nav_StartFollowReverse(void)
 {
+  UseTurnRamps(false);
   lastError     = 0;
   lineLostCount = 0;
   tIntersectionPublished = false;
@@ -1188,6 +1274,7 @@ void Nav_StartFollowReverse(void)
 ****************************************************************************/
 void Nav_StartFollowForward(void)
 {
+  UseTurnRamps(false);
   lastError              = 0;
   lineLostCount          = 0;
   tIntersectionPublished = false;
@@ -1219,6 +1306,7 @@ void Nav_StartFollowForward(void)
 ****************************************************************************/
 static void StartRotation(uint8_t leftDir, uint8_t rightDir, uint32_t targetArc_mm)
 {
+  UseTurnRamps(true);
   // Record odometer baseline before motion begins
   RotateStartDistLeft_mm  = ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR));
   RotateStartDistRight_mm = ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR));
@@ -1240,6 +1328,34 @@ static void StartRotation(uint8_t leftDir, uint8_t rightDir, uint32_t targetArc_
             (unsigned)RotateStartDistRight_mm);
 }
 
+/****************************************************************************
+ Function
+     ClampMoveDistance
+
+ Parameters
+     uint32_t dist_mm - requested straight move distance
+
+ Returns
+     uint32_t - dist_mm, at most NAV_MAX_MOVE_MM
+
+ Description
+     Keeps straight moves within what MOVE_SAFETY_TIMEOUT_MS and the 16-bit
+     distances of DCMotor_MoveDistance_mm can express.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static uint32_t ClampMoveDistance(uint32_t dist_mm)
+{
+  if (dist_mm > NAV_MAX_MOVE_MM)
+  {
+    DB_printf("Nav: move of %u mm clamped to %u mm\r\n",
+              (unsigned)dist_mm, (unsigned)NAV_MAX_MOVE_MM);
+    return NAV_MAX_MOVE_MM;
+  }
+  return dist_mm;
+}
+
 /****************************************************************************
  Function
      Nav_RotateCW
@@ -1283,6 +1399,7 @@ void Nav_RotateCW(uint8_t degrees)
 ****************************************************************************/
 void Nav_RotateCWRadius(uint8_t degrees, uint32_t radius_mm)
 {
+  UseTurnRamps(false);
   uint32_t halfW = TRACK_WIDTH_MM / 2u;
 
   // CW turn: right wheel is inner, left wheel is outer
@@ -1400,6 +1517,7 @@ void Nav_RotateCCW(uint8_t degrees)
 ****************************************************************************/
 void Nav_RotateCCWRadius(uint8_t degrees, uint32_t radius_mm)
 {
+  UseTurnRamps(false);
   uint32_t halfW = TRACK_WIDTH_MM / 2u;
 
   // CCW turn: left wheel is inner, right wheel is outer
@@ -1486,20 +1604,30 @@ void Nav_RotateCCWRadius(uint8_t degrees, uint32_t radius_mm)
 
  Description
      Drives forward in a straight line for the specified distance using
-     odometer feedback.
+     odometer feedback. With NAV_POSITION_MOVES the move runs in
+     DCMotorService position mode and completes on ES_MOVE_SETTLED.
+     Distances over NAV_MAX_MOVE_MM are clamped to it.
 
  Author
      Team, 03/02/26
 ****************************************************************************/
 void Nav_MoveForward_mm(uint32_t dist_mm)
 {
+  UseTurnRamps(false);
+  dist_mm = ClampMoveDistance(dist_mm);
   MoveStartDistLeft_mm  = ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR));
   MoveStartDistRight_mm = ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR));
   MoveTargetDist_mm     = dist_mm;
 
+#if NAV_POSITION_MOVES
+  DCMotor_MoveDistance_mm((uint16_t)dist_mm, (uint16_t)dist_mm,
+                          FORWARD, FORWARD, NAV_MOVE_SPEED_MM_S);
+  ES_Timer_InitTimer(ROTATE_SAFETY_TIMER, MOVE_SAFETY_TIMEOUT_MS(dist_mm));
+#else
   DCMotor_SetSpeed_mm_s(BASE_FOLLOW_SPEED_MM_S, BASE_FOLLOW_SPEED_MM_S,
                         FORWARD, FORWARD);
   ES_Timer_InitTimer(TAPE_FOLLOW_TIMER, ROTATE_POLL_INTERVAL_MS);
+#endif
   CurrentState = NavMovingForward;
 
   DB_printf("Nav: MoveForward %u mm\r\n", (unsigned)dist_mm);
@@ -1524,6 +1652,7 @@ void Nav_MoveForward_mm(uint32_t dist_mm)
 ****************************************************************************/
 void Nav_MoveForward_mm_Follow(uint32_t dist_mm)
 {
+  UseTurnRamps(false);
   FollowForwardStartDistLeft_mm  = ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR));
   FollowForwardStartDistRight_mm = ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR));
   FollowForwardTargetDist_mm     = dist_mm;
@@ -1559,6 +1688,7 @@ void Nav_MoveForward_mm_Follow(uint32_t dist_mm)
 ****************************************************************************/
 void Nav_MoveBackward_mm_Follow(uint32_t dist_mm)
 {
+  UseTurnRamps(false);
   FollowReverseStartDistLeft_mm  = ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR));
   FollowReverseStartDistRight_mm = ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR));
   FollowReverseTargetDist_mm     = dist_mm;
@@ -1587,20 +1717,30 @@ void Nav_MoveBackward_mm_Follow(uint32_t dist_mm)
 
  Description
      Drives backward in a straight line for the specified distance using
-     odometer feedback.
+     odometer feedback. With NAV_POSITION_MOVES the move runs in
+     DCMotorService position mode and completes on ES_MOVE_SETTLED.
+     Distances over NAV_MAX_MOVE_MM are clamped to it.
 
  Author
      Team, 03/02/26
 ****************************************************************************/
 void Nav_MoveBackward_mm(uint32_t dist_mm)
 {
+  UseTurnRamps(false);
+  dist_mm = ClampMoveDistance(dist_mm);
   MoveBackStartDistLeft_mm  = ICCountToDistance_mm(DCMotor_GetICEventCount(LEFT_MOTOR));
   MoveBackStartDistRight_mm = ICCountToDistance_mm(DCMotor_GetICEventCount(RIGHT_MOTOR));
   MoveBackTargetDist_mm     = dist_mm;
 
+#if NAV_POSITION_MOVES
+  DCMotor_MoveDistance_mm((uint16_t)dist_mm, (uint16_t)dist_mm,
+                          REVERSE, REVERSE, NAV_MOVE_SPEED_MM_S);
+  ES_Timer_InitTimer(ROTATE_SAFETY_TIMER, MOVE_SAFETY_TIMEOUT_MS(dist_mm));
+#else
   DCMotor_SetSpeed_mm_s(BASE_FOLLOW_SPEED_REV_MM_S, BASE_FOLLOW_SPEED_REV_MM_S,
                         REVERSE, REVERSE);
   ES_Timer_InitTimer(TAPE_FOLLOW_TIMER, ROTATE_POLL_INTERVAL_MS);
+#endif
   CurrentState = NavMovingBackward;
 
   DB_printf("Nav: MoveBackward %u mm\r\n", (unsigned)dist_mm);
@@ -1625,6 +1765,7 @@ void Nav_MoveBackward_mm(uint32_t dist_mm)
 ****************************************************************************/
 void Nav_StartRotateContinuous(bool clockwise)
 {
+  UseTurnRamps(true);
   if (clockwise)
   {
     DCMotor_SetSpeed_mm_s(ROTATE_SPEED_MM_S, ROTATE_SPEED_MM_S,
@@ -1665,5 +1806,61 @@ void Nav_Stop(void)
   DB_printf("Nav: Stop\r\n");
 }
 
+/****************************************************************************
+ Function
+     Nav_EmergencyStop
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     As Nav_Stop, but the wheels stop at once instead of ramping down at
+     the decel limit (DCMotor_StopNow).
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+void Nav_EmergencyStop(void)
+{
+  DCMotor_StopNow();
+  ES_Timer_StopTimer(TAPE_FOLLOW_TIMER);
+  ES_Timer_StopTimer(ROTATE_SAFETY_TIMER);
+  CurrentState = NavIdle;
+  DB_printf("Nav: Emergency stop\r\n");
+}
+
+/****************************************************************************
+ Function
+     UseTurnRamps
+
+ Parameters
+     bool pointTurn - the behavior about to start is a point turn
+
+ Returns
+     None
+
+ Description
+     Selects the setpoint ramp limits for the behavior about to start.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void UseTurnRamps(bool pointTurn)
+{
+  if (pointTurn)
+  {
+    DCMotor_SetRampLimits(TURN_RAMP_ACCEL_MM_S2, TURN_RAMP_DECEL_MM_S2,
+                          TURN_RAMP_JERK_MM_S3);
+  }
+  else
+  {
+    DCMotor_SetRampLimits(DRIVE_RAMP_ACCEL_MM_S2, DRIVE_RAMP_DECEL_MM_S2,
+                          DRIVE_RAMP_JERK_MM_S3);
+  }
+}
+
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
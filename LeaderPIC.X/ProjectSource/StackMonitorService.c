@@ -0,0 +1,195 @@
+/****************************************************************************
+ Module
+   StackMonitorService.c
+
+ Revision
+   1.0.0
+
+ Description
+   Watches how much of the stack has been used. The startup code in
+   ES_Port.c paints the free stack; this service scans it a slice at a
+   time for the high-water mark, prints it whenever it or the maximum ISR
+   nesting depth has grown, and halts through _HW_StackFault if the high
+   water reaches the guard band above the heap and .bss.
+
+ Notes
+   Profiled ISR entries also check the stack pointer directly (ES_Port.c),
+   which catches a deep excursion between scans. With ES_STACK_MONITOR off
+   the service just consumes its ES_INIT.
+
+   Use the reported high water, plus a margin, when shrinking the stack to
+   give RAM to something else.
+
+ History
+ When           Who     What/Why
+ -------------- ---     --------
+ 10/17/26       Team    Initial creation
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "StackMonitorService.h"
+#include "dbprintf.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define STACK_SCAN_INTERVAL_MS  20u     // one scan slice per interval
+#define STACK_SCAN_WORDS        1024u   // about 100us per slice
+#define STACK_REPORT_MIN_MS     5000u   // at most one report per 5 seconds
+
+/*---------------------------- Module Functions ---------------------------*/
+#ifdef ES_STACK_MONITOR
+static void CheckHighWater(void);
+#endif
+
+/*---------------------------- Module Variables ---------------------------*/
+static uint8_t MyPriority;
+
+#ifdef ES_STACK_MONITOR
+static uint32_t ReportedHighWater;
+static uint8_t  ReportedISRDepth;
+static uint16_t LastReportTime;
+static bool     FirstReport = true;
+#endif
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitStackMonitorService
+
+ Parameters
+     uint8_t : the priority of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves the priority and starts the scan timer
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool InitStackMonitorService(uint8_t Priority)
+{
+  ES_Event_t ThisEvent;
+
+  MyPriority = Priority;
+
+#ifdef ES_STACK_MONITOR
+  ES_Timer_InitTimer(STACK_MONITOR_TIMER, STACK_SCAN_INTERVAL_MS);
+#endif
+
+  ThisEvent.EventType = ES_INIT;
+  return ES_PostToService(MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+     PostStackMonitorService
+
+ Parameters
+     ES_Event_t ThisEvent, the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this service's queue
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+bool PostStackMonitorService(ES_Event_t ThisEvent)
+{
+  return ES_PostToService(MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunStackMonitorService
+
+ Parameters
+   ES_Event_t : the event to process
+
+ Returns
+   ES_Event_t, ES_NO_EVENT
+
+ Description
+   On each STACK_MONITOR_TIMER timeout scans the next slice of the stack
+   and, once a pass is complete, checks and reports the high water.
+
+ Author
+   Team, 10/17/26
+****************************************************************************/
+ES_Event_t RunStackMonitorService(ES_Event_t ThisEvent)
+{
+  ES_Event_t ReturnEvent;
+  ReturnEvent.EventType = ES_NO_EVENT;
+
+#ifdef ES_STACK_MONITOR
+  if ((ThisEvent.EventType == ES_TIMEOUT) &&
+      (ThisEvent.EventParam == STACK_MONITOR_TIMER))
+  {
+    if (_HW_StackScanStep(STACK_SCAN_WORDS))
+    {
+      CheckHighWater();
+    }
+    ES_Timer_InitTimer(STACK_MONITOR_TIMER, STACK_SCAN_INTERVAL_MS);
+  }
+#endif
+  return ReturnEvent;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+#ifdef ES_STACK_MONITOR
+/****************************************************************************
+ Function
+     CheckHighWater
+
+ Parameters
+     None
+
+ Returns
+     None
+
+ Description
+     Halts if the high water has reached the guard band, otherwise prints
+     it when it or the ISR nesting depth has grown, rate limited to one
+     report per STACK_REPORT_MIN_MS.
+
+ Author
+     Team, 10/17/26
+****************************************************************************/
+static void CheckHighWater(void)
+{
+  uint32_t StackSize = _HW_GetStackSize();
+  uint32_t HighWater = _HW_GetStackHighWater();
+  uint8_t  ISRDepth = 0;
+  uint16_t Now = ES_Timer_GetTime();
+
+#ifdef ES_ISR_PROFILE
+  ISRDepth = _HW_GetMaxISRDepth();
+#endif
+
+  if ((HighWater + ES_STACK_GUARD_BYTES) >= StackSize)
+  {
+    _HW_StackFault("stack high water in guard band");
+  }
+
+  if (((HighWater > ReportedHighWater) || (ISRDepth > ReportedISRDepth)) &&
+      (FirstReport ||
+       ((uint16_t)(Now - LastReportTime) >= STACK_REPORT_MIN_MS)))
+  {
+    DB_printf("Stack high water %u of %u bytes (%u%%), max ISR nesting %u\r\n",
+              HighWater, StackSize, (HighWater * 100u) / StackSize, ISRDepth);
+    ReportedHighWater = HighWater;
+    ReportedISRDepth  = ISRDepth;
+    LastReportTime    = Now;
+    FirstReport       = false;
+  }
+}
+#endif
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
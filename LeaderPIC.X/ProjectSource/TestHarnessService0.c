@@ -14,6 +14,11 @@
  History
  When           Who     What/Why
  -------------- ---     --------
+ 10/17/26       Team    'T' key times a short timer one-shot
+ 10/17/26       Team    'u' key also prints stack high water
+ 10/17/26       Team    added 'I' key to dump and reset the ISR profile
+ 10/17/26       Team    'u' key also prints event checker costs
+ 10/17/26       Team    added 'u' key to print CPU utilisation
  10/26/17 18:26 jec     moves definition of ALL_BITS to ES_Port.h
  10/19/17 21:28 jec     meaningless change to test updating
  10/19/17 18:42 jec     removed referennces to driverlib and programmed the
@@ -39,7 +44,9 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "ES_DeferRecall.h"
+#include "ES_CheckEvents.h"
 #include "ES_Port.h"
+#include "ES_ShortTimer.h"
 #include "terminal.h"
 #include "dbprintf.h"
 
@@ -57,6 +64,9 @@
 #define TWO_SEC (ONE_SEC * 2)
 #define FIVE_SEC (ONE_SEC * 5)
 
+#define SHORT_TIMER_TEST_uS  500u   // 'T' key one-shot on TIMER_A
+#define CORE_COUNTS_PER_uS   20u
+
 #define ENTER_POST     ((MyPriority<<3)|0)
 #define ENTER_RUN      ((MyPriority<<3)|1)
 #define ENTER_TIMEOUT  ((MyPriority<<3)|2)
@@ -79,6 +89,8 @@ static void StartTMR2(void);
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 static uint8_t MyPriority;
+// core timer count when the 'T' key started TIMER_A
+static uint32_t ShortTimerStartCount;
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -104,6 +116,8 @@ bool InitTestHarnessService0(uint8_t Priority)
   ES_Event_t ThisEvent;
 
   MyPriority = Priority;
+  // key strokes are published, so ask for them
+  ES_Subscribe(MyPriority, ES_NEW_KEY);
 
   // When doing testing, it is useful to announce just which program
   // is running.
@@ -148,7 +162,7 @@ bool InitTestHarnessService0(uint8_t Priority)
   InitTMR2();
 #endif
   // initialize the Short timer system for channel A
-  //ES_ShortTimerInit(MyPriority, SHORT_TIMER_UNUSED);
+  ES_ShortTimerInit(MyPriority, SHORT_TIMER_UNUSED);
 
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
@@ -246,7 +260,9 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
     break;
     case ES_SHORT_TIMEOUT:   // lower the line & announce
     {
-      puts("\rES_SHORT_TIMEOUT received\r\n");
+      DB_printf("ES_SHORT_TIMEOUT %u received, %u us after the start\r\n",
+                ThisEvent.EventParam,
+                (_CP0_GET_COUNT() - ShortTimerStartCount) / CORE_COUNTS_PER_uS);
     }
     break;
     case ES_NEW_KEY:   // announce and handle servo control keys
@@ -331,6 +347,74 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
           DB_printf("Posted CMD_INIT_SERVOS to SPILeaderFSM\r\n");
           break;
           
+        case 'u':  // Print CPU utilisation over the last second
+        {
+          uint8_t idlePercent = _HW_GetIdlePercent();
+          DB_printf("CPU idle %d%%, busy %d%%\r\n", idlePercent,
+                    100 - idlePercent);
+
+          // cost of each event checker, in core timer counts (50ns each)
+          ES_CheckerStats_t checkerStats;
+          const char *checkerName;
+          uint8_t i;
+          for (i = 0; i < ES_GetNumCheckers(); i++)
+          {
+            checkerName = ES_GetCheckerStats(i, &checkerStats);
+            DB_printf("%s: calls %u, avg %u, max %u\r\n", checkerName,
+                      checkerStats.NumCalls,
+                      (checkerStats.NumCalls != 0) ?
+                      checkerStats.TotalCycles / checkerStats.NumCalls : 0,
+                      checkerStats.MaxCycles);
+          }
+#ifdef ES_STACK_MONITOR
+          // high water as of the stack monitor's last completed scan
+          DB_printf("Stack high water %u of %u bytes\r\n",
+                    _HW_GetStackHighWater(), _HW_GetStackSize());
+#endif
+        }
+        break;
+
+#ifdef ES_ISR_PROFILE
+        case 'I':  // Dump ISR time & jitter histograms since the last dump
+        {
+          // times in core timer counts (50ns); histogram bin k holds
+          // 2^(k-1) to 2^k - 1 counts, so each column doubles
+          ES_ISRStats_t isrStats;
+          const char *isrName;
+          uint8_t i;
+          uint8_t bin;
+          for (i = 0; i < _HW_GetNumISRSlots(); i++)
+          {
+            isrName = _HW_GetISRStats(i, &isrStats);
+            DB_printf("%s: calls %u, avg %u, max %u, max jitter %u\r\n",
+                      isrName, isrStats.NumCalls,
+                      (isrStats.NumCalls != 0) ?
+                      isrStats.TotalExecCycles / isrStats.NumCalls : 0,
+                      isrStats.MaxExecCycles, isrStats.MaxJitterCycles);
+            DB_printf("  exec  ");
+            for (bin = 0; bin < ES_ISR_HIST_BINS; bin++)
+            {
+              DB_printf(" %u", isrStats.ExecHist[bin]);
+            }
+            DB_printf("\r\n  jitter");
+            for (bin = 0; bin < ES_ISR_HIST_BINS; bin++)
+            {
+              DB_printf(" %u", isrStats.JitterHist[bin]);
+            }
+            DB_printf("\r\n");
+          }
+          _HW_ResetISRStats();
+        }
+        break;
+#endif
+
+        case 'T':  // Time a short timer one-shot, start to dispatch
+        {
+          ShortTimerStartCount = _CP0_GET_COUNT();
+          ES_ShortTimerStart(TIMER_A, SHORT_TIMER_TEST_uS);
+        }
+        break;
+
         case 'h':  // Help - display key mappings
           DB_printf("\r\n=== Servo Control Keys (send via SPI to Follower) ===\r\n");
           DB_printf("w - Sweep servo action\r\n");
@@ -340,6 +424,9 @@ ES_Event_t RunTestHarnessService0(ES_Event_t ThisEvent)
           DB_printf("r - Release servo action\r\n");
           DB_printf("f - Shoot servo action (fire)\r\n");
           DB_printf("i - Initialize all servos\r\n");
+          DB_printf("u - Print CPU utilisation & event checker costs\r\n");
+          DB_printf("I - Dump & reset ISR time/jitter histograms\r\n");
+          DB_printf("T - Time a 500us short timer (TIMER_A)\r\n");
           DB_printf("h - Display this help\r\n");
           DB_printf("================================================\r\n\n");
           DB_printf("\r\n=== Field Test Event Injection Keys ===\r\n");
@@ -14,12 +14,20 @@
 #include "ES_Configure.h"
 #include "ES_Framework.h"
 #include "ES_Port.h"
+#include "DCMotorService.h"
 
 
 void main(void)
 {
   ES_Return_t ErrorType = Success;
 
+#ifdef ES_STACK_MONITOR
+  // A stack fault can be caught from any ISR, and the framework's own are
+  // enabled before the services initialise, so stop the wheels from the
+  // very start. DCMotor_EmergencyOff only writes registers, it needs no init.
+  _HW_SetSafeStateHandler(DCMotor_EmergencyOff);
+#endif
+
   _HW_PIC32Init(); // basic PIC hardware init
   // Your hardware initialization function calls go here
 